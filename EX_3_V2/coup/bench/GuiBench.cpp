@@ -0,0 +1,182 @@
+// thelet.shevach@gmail.com
+/*  GuiBench – headless GUI benchmark / golden-image checker.
+
+    Replays a scripted game through SFMLWindow::renderFrame into an
+    sf::RenderTexture (no window is ever opened) and reports frame-time
+    percentiles.  With --golden it also diffs every frame against
+    DIR/step_NNN.png, --update-golden (re)writes those files instead.
+
+    usage: ./GuiBench [script] [--repeat N] [--golden DIR] [--update-golden]
+                      [--tolerance T]
+
+    Script format (one command per line, '#' starts a comment):
+        players Governor:Moshe Spy:Yossi Baron:Meirav
+        gather | tax | bribe | invest          – current player
+        arrest S | sanction S | coup S         – S = target seat
+        block S                                – seat S blocks             */
+#include <SFML/Graphics.hpp>
+#include "gui/SFMLWindow.hpp"
+#include "core/Game.hpp"
+#include "core/Player.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace coup;
+
+namespace {
+
+const char* kDefaultScript =
+    "players Governor:Moshe Spy:Yossi Baron:Meirav General:Reut Judge:Gilad\n"
+    "gather\ngather\ngather\ngather\ngather\n"
+    "gather\ntax\nblock 0\n"
+    "tax\ngather\ngather\n"
+    "tax\ngather\ninvest\ngather\ngather\n"
+    "tax\ngather\ngather\ngather\ngather\n"
+    "tax\ngather\ncoup 0\ngather\ngather\n";
+
+std::unique_ptr<Player> makePlayer(Game& g, const std::string& role,
+                                   const std::string& name)
+{
+    if(role=="Governor") return std::make_unique<Governor>(g,name);
+    if(role=="Spy")      return std::make_unique<Spy>(g,name);
+    if(role=="Baron")    return std::make_unique<Baron>(g,name);
+    if(role=="General")  return std::make_unique<General>(g,name);
+    if(role=="Judge")    return std::make_unique<Judge>(g,name);
+    return std::make_unique<Merchant>(g,name);
+}
+
+/* one script line → state change; illegal moves are reported, not fatal */
+void applyLine(Game& g, std::istringstream& in, const std::string& cmd)
+{
+    std::size_t seat = 0;
+    const std::size_t me = g.turnIndex();
+    if     (cmd=="gather")   g.perform({Action::Type::Gather, me, {}});
+    else if(cmd=="tax")      g.perform({Action::Type::Tax,    me, {}});
+    else if(cmd=="bribe")    g.perform({Action::Type::Bribe,  me, {}});
+    else if(cmd=="invest")   dynamic_cast<Baron&>(*g.roster().at(me)).invest();
+    else if(cmd=="arrest"   && in >> seat) g.perform({Action::Type::Arrest,   me, seat});
+    else if(cmd=="sanction" && in >> seat) g.perform({Action::Type::Sanction, me, seat});
+    else if(cmd=="coup"     && in >> seat) g.perform({Action::Type::Coup,     me, seat});
+    else if(cmd=="block"    && in >> seat) g.block  ({Action::Type::Block,  seat, {}});
+    else throw IllegalAction("unknown script command: " + cmd);
+}
+
+/* pixels whose largest channel difference exceeds `tol` */
+std::size_t diffPixels(const sf::Image& a, const sf::Image& b, int tol)
+{
+    if(a.getSize()!=b.getSize()) return static_cast<std::size_t>(-1);
+    const sf::Uint8* pa = a.getPixelsPtr();
+    const sf::Uint8* pb = b.getPixelsPtr();
+    const std::size_t n = std::size_t(a.getSize().x) * a.getSize().y;
+    std::size_t bad = 0;
+    for(std::size_t i=0;i<n;++i){
+        int worst = 0;
+        for(int c=0;c<4;++c)
+            worst = std::max(worst, std::abs(int(pa[4*i+c]) - int(pb[4*i+c])));
+        if(worst > tol) ++bad;
+    }
+    return bad;
+}
+
+double percentile(std::vector<double> v, double p)
+{
+    if(v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size()-1, static_cast<std::size_t>(p * v.size()))];
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::string scriptPath, goldenDir;
+    bool   update    = false;
+    int    repeat    = 50;
+    int    tolerance = 8;
+    for(int i=1;i<argc;++i){
+        std::string a = argv[i];
+        if     (a=="--repeat"    && i+1<argc) repeat    = std::stoi(argv[++i]);
+        else if(a=="--golden"    && i+1<argc) goldenDir = argv[++i];
+        else if(a=="--tolerance" && i+1<argc) tolerance = std::stoi(argv[++i]);
+        else if(a=="--update-golden")         update    = true;
+        else                                  scriptPath = a;
+    }
+
+    std::stringstream script;
+    if(scriptPath.empty()) script << kDefaultScript;
+    else {
+        std::ifstream f(scriptPath);
+        if(!f){ std::cerr << "cannot open " << scriptPath << '\n'; return 2; }
+        script << f.rdbuf();
+    }
+
+    Game g;
+    std::vector<std::unique_ptr<Player>> seats;
+    sf::RenderTexture rt;
+    if(!rt.create(800,800)){ std::cerr << "cannot create render texture\n"; return 2; }
+    coup_gui::SFMLWindow gui(g);
+
+    std::vector<double> frameMs;
+    std::size_t step = 0, failed = 0;
+    std::string line;
+    while(std::getline(script,line)){
+        line = line.substr(0, line.find('#'));
+        std::istringstream in(line);
+        std::string cmd;
+        if(!(in >> cmd)) continue;
+
+        if(cmd=="players"){
+            for(std::string spec; in >> spec; ){
+                auto colon = spec.find(':');
+                std::string role = spec.substr(0,colon);
+                std::string name = colon==std::string::npos ? "P"+std::to_string(seats.size()+1)
+                                                            : spec.substr(colon+1);
+                seats.push_back(makePlayer(g,role,name));
+            }
+            continue;
+        }
+        try { applyLine(g,in,cmd); }
+        catch(const std::exception& e){ std::cerr << "step " << step << ": " << e.what() << '\n'; }
+
+        /* timed frames – the last one is kept for the golden comparison */
+        for(int r=0;r<repeat;++r){
+            auto t0 = std::chrono::steady_clock::now();
+            gui.renderFrame(rt);
+            rt.display();
+            auto t1 = std::chrono::steady_clock::now();
+            frameMs.push_back(std::chrono::duration<double,std::milli>(t1-t0).count());
+        }
+
+        if(!goldenDir.empty()){
+            char file[32];
+            std::snprintf(file, sizeof file, "/step_%03zu.png", step);
+            const sf::Image frame = rt.getTexture().copyToImage();
+            if(update) frame.saveToFile(goldenDir + file);
+            else {
+                sf::Image golden;
+                if(!golden.loadFromFile(goldenDir + file)){ ++failed; }
+                else if(std::size_t bad = diffPixels(frame,golden,tolerance)){
+                    std::cerr << "step " << step << ": " << bad << " pixels differ\n";
+                    ++failed;
+                }
+            }
+        }
+        ++step;
+    }
+
+    std::printf("frames %zu  p50 %.3f ms  p90 %.3f ms  p99 %.3f ms  max %.3f ms\n",
+                frameMs.size(), percentile(frameMs,.50), percentile(frameMs,.90),
+                percentile(frameMs,.99), percentile(frameMs,1.0));
+    if(!goldenDir.empty() && !update)
+        std::printf("golden: %zu/%zu steps differ\n", failed, step);
+    return failed ? 1 : 0;
+}
@@ -1,6 +1,8 @@
 // thelet.shevach@gmail.com
 #pragma once
+#include <cstdint>
 #include <optional>
+#include <stdexcept>
 
 namespace coup {
 
@@ -15,6 +17,43 @@ struct Action {
     Type          type;
     std::size_t   actor;                 // index in Game::roster()
     std::optional<std::size_t> target;   // some actions need a victim
+
+    bool operator==(const Action&) const = default;
+};
+
+/* ActionCode – an Action in 16 bits: type (4) | actor (6) | target (6),
+   target 63 meaning none.  For move lists, logs and search nodes; seats
+   0..62 only.  Codes compare equal exactly when their Actions do.      */
+class ActionCode {
+public:
+    static constexpr std::size_t   kMaxSeats = 63;
+    static constexpr std::uint16_t kNoTarget = 63;
+
+    constexpr ActionCode() = default;
+    constexpr explicit ActionCode(const Action& a) : bits_(pack(a)) {}   // throws std::out_of_range
+
+    static constexpr ActionCode fromBits(std::uint16_t b) { ActionCode c; c.bits_ = b; return c; }
+    constexpr std::uint16_t bits() const { return bits_; }
+
+    constexpr Action::Type type()   const { return static_cast<Action::Type>(bits_ >> 12); }
+    constexpr std::size_t  actor()  const { return bits_ >> 6 & 63u; }
+    constexpr bool         hasTarget() const { return (bits_ & 63u) != kNoTarget; }
+    constexpr std::size_t  target() const { return bits_ & 63u; }
+
+    constexpr Action decode() const {
+        return {type(), actor(), hasTarget() ? std::optional<std::size_t>(target()) : std::nullopt};
+    }
+    constexpr bool operator==(const ActionCode&) const = default;
+
+private:
+    static constexpr std::uint16_t pack(const Action& a) {
+        if(a.actor >= kMaxSeats || (a.target && *a.target >= kMaxSeats))
+            throw std::out_of_range("ActionCode: seats must be below 63");
+        return static_cast<std::uint16_t>(static_cast<unsigned>(a.type) << 12
+                                        | a.actor << 6
+                                        | (a.target ? *a.target : kNoTarget));
+    }
+    std::uint16_t bits_{kNoTarget};              // Gather by seat 0
 };
 
 } // namespace coup
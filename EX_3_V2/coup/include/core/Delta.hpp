@@ -0,0 +1,57 @@
+// thelet.shevach@gmail.com
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace coup {
+
+/* Delta – everything one accepted action changed.
+   Coins are sent as the seat's new absolute value (so a consumer that
+   missed an out-of-band addCoins() still converges).  Seat fields hold
+   Delta::none when absent.                                              */
+struct Delta {
+    static constexpr std::uint16_t none = 0xFFFF;
+
+    struct Coins { std::uint16_t seat; std::uint32_t value; };
+
+    std::array<Coins,4> coins{};           // actor, target, blocker, next turn
+    std::uint8_t        nCoins{0};
+    std::uint16_t       died       {none}; // couped
+    std::uint16_t       revived    {none}; // General blocked the coup
+    std::uint16_t       turn       {none}; // new turn holder
+    std::uint16_t       sanctionOn {none};
+    std::uint16_t       sanctionOff{none};
+
+    bool empty() const {
+        return !nCoins && died==none && revived==none && turn==none
+            && sanctionOn==none && sanctionOff==none;
+    }
+};
+
+/* wire format: 1 header byte (bits 0-2 coin count, bits 3-7 presence of
+   died / revived / turn / sanctionOn / sanctionOff) then LEB128 varints.
+   A plain gather is 4 bytes.                                            */
+std::size_t encode(const Delta& d, std::vector<std::uint8_t>& out);  // appends, returns size
+Delta       decode(const std::uint8_t*& p);                          // advances p
+
+/* append-only encoded stream – what a server, spectator feed or log keeps */
+class DeltaStream {
+public:
+    void operator()(const Delta& d) { encode(d, bytes_); ++count_; }
+
+    const std::vector<std::uint8_t>& bytes() const { return bytes_; }
+    std::size_t count()       const { return count_; }
+    double      averageSize() const { return count_ ? double(bytes_.size())/count_ : 0.0; }
+
+    template<class F> void replay(F&& f) const {
+        const std::uint8_t* p = bytes_.data();
+        for(std::size_t i=0;i<count_;++i) f(decode(p));
+    }
+private:
+    std::vector<std::uint8_t> bytes_;
+    std::size_t               count_{0};
+};
+
+} // namespace coup
@@ -1,10 +1,16 @@
 // thelet.shevach@gmail.com
 #pragma once
 
+#include <array>
 #include <vector>
 #include <string>
 #include <optional>
+#include <span>
+#include <functional>
+#include <iterator>
 #include "core/Action.hpp"
+#include "core/Delta.hpp"
+#include "core/NameTable.hpp"
 #include "util/Exceptions.hpp"
 
 namespace coup {
@@ -12,14 +18,32 @@ namespace coup {
 class Player;              // forward
 
 class Game {
+    friend class Player;               // handles reach their seat's fields
+
     /* ── state ─────────────────────────────────────────────── */
     std::vector<Player*> roster_;      // players in join order
     std::vector<bool>    alive_;       // still in the game
+    std::size_t          aliveCount_{0};
+
+    /* per-seat hot fields, one array each: perform() reads and writes
+       these instead of following roster_ into every Player           */
+    std::vector<int>         coins_;
+    std::vector<std::size_t> lastArrested_;      // seat last arrested, or -1
+    std::vector<std::size_t> sanctionedUntil_;   // tick a sanction runs to, 0 = none
+
+    /* names are presentation only: interned once at join, looked up by seat */
+    NameTable                names_;
+    std::vector<NameTable::Id> nameIds_;
+    /* ring of living seats in turn order (dancing links): an eliminated
+       seat is unlinked but keeps its own next_/prev_, so a revival –
+       which always undoes the latest coup – relinks it in O(1)          */
+    std::vector<std::size_t> next_, prev_;
+    std::size_t              head_{0};     // lowest living seat
     std::size_t          turnIdx_{0};  // whose turn (index into roster_)
     std::size_t          tick_{0};     // “full-turns” counter
 
 
-    std::optional<Action> pending_;
+    std::optional<Action> pending_;    // proposed, not yet applied
 
     /* lastBlockable_ – remembers the most-recent Tax / Bribe / Coup
        and stays valid until that same actor’s *next* turn.          */
@@ -29,42 +53,206 @@ class Game {
     };
     std::optional<Remembered> lastBlockable_;
 
+    /* delta journal – seats touched by the action in flight, with the
+       values they had before it; diffed into a Delta on acceptance     */
+    struct Touched {
+        std::size_t seat;
+        int         coins;
+        std::size_t lastArrested;
+        std::size_t sanctionedUntil;
+        bool        alive;
+    };
+    std::array<Touched,4> touched_{};
+    std::size_t           nTouched_{0};
+    std::size_t           turnBefore_{0};
+    std::vector<std::pair<std::size_t, std::function<void(const Delta&)>>> sinks_;
+    std::size_t           nextSinkId_{0};
+    bool                  muted_{false};      // make(): no deltas to sinks
+
+public:
+    /* what a Spy learned: `target` held `coins` at tick `tick` */
+    struct Peek {
+        std::size_t spy, target, tick;
+        int         coins;
+    };
+private:
+    std::vector<Peek>     peeks_;             // latest per (spy,target)
+
     /* ── internal helpers ───────────────────────────────────── */
     Player&       playerAt(std::size_t i);
     const Player& playerAt(std::size_t i) const;
     void          nextTurn();                 // advance to next living player
-    void          enforce10CoinRule(Player&); // throw if ≥10 coins
+    void          unlink(std::size_t seat);   // seat left the game
+    void          relink(std::size_t seat);   // seat came back
+    void          rebuildRing();              // from alive_ (join / load)
+    void          enforce10CoinRule(std::size_t seat, Action::Type); // ≥10 coins → coup only
+    void          spend(std::size_t seat, int c);     // throws NotEnoughCoins
     void          recordBlockable(const Action&); // fill lastBlockable_
+    void          beginDelta();               // reset the journal
+    void          touch(std::size_t seat);    // remember seat's old values
+    void          emitDelta();                // diff journal → sinks
+    void          emitNet(const Touched* seats, std::size_t n, std::size_t turnBefore);
+    void          blockPending(const Action& b);  // block() while something is proposed
 
 public:
     explicit Game() = default;
     ~Game() = default;
 
-    void registerPlayer(Player* p);    // called from Player ctor
+    void registerPlayer(Player* p, const std::string& name);    // called from Player ctor
+
+    /* ---- living players, in seat order, without allocating --
+       for(const Player& p : g.living()) …   it.seat() gives the index.
+       Walks the living-seat ring; any accepted action invalidates it. */
+    class LivingView {
+    public:
+        class iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type        = Player;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = const Player*;
+            using reference         = const Player&;
+
+            iterator() = default;
+            reference   operator*()  const { return *g_->roster_[seat_]; }
+            pointer     operator->() const { return g_->roster_[seat_]; }
+            std::size_t seat()       const { return seat_; }
+            iterator&   operator++()       { seat_ = g_->next_[seat_]; --left_; return *this; }
+            iterator    operator++(int)    { iterator t = *this; ++*this; return t; }
+            bool operator==(const iterator& o) const { return left_ == o.left_; }
+        private:
+            friend class LivingView;
+            iterator(const Game* g, std::size_t seat, std::size_t left) : g_(g), seat_(seat), left_(left) {}
+            const Game* g_{nullptr};
+            std::size_t seat_{0}, left_{0};
+        };
+
+        iterator    begin() const { return {g_, g_->head_, g_->aliveCount_}; }
+        iterator    end()   const { return {g_, 0, 0}; }
+        std::size_t size()  const { return g_->aliveCount_; }
+        bool        empty() const { return g_->aliveCount_ == 0; }
+    private:
+        friend class Game;
+        explicit LivingView(const Game* g) : g_(g) {}
+        const Game* g_;
+    };
+    LivingView  living()      const { return LivingView(this); }
+    bool        isOver()      const { return aliveCount_ <= 1; }
+    std::size_t winnerIndex() const;            // O(1); throws while several are alive
 
-    /* ---- public API used by Demo / GUI --------------------- */
-    std::vector<std::string> players() const;   // living players
+    /* ---- public API used by Demo / GUI ---------------------
+       names for display; engine code and drivers compare seats
+       (turnIndex(), Player::seat(), winnerIndex())              */
+    std::vector<std::string> players() const;   // living players (copies – prefer living())
     const std::string&       turn()    const;   // whose turn name
     std::string              winner()  const;   // last survivor
+    const std::string&       nameOf(std::size_t seat) const { return names_.name(nameIds_.at(seat)); }
+    NameTable::Id            nameId(std::size_t seat) const { return nameIds_.at(seat); }
+    const NameTable&         names()  const { return names_; }
 
     const std::vector<Player*>& roster()  const { return roster_; }
     bool                        alive(std::size_t i) const { return alive_.at(i); }
+    std::size_t                 aliveCount() const { return aliveCount_; }
+    /* living seat after / before `seat` in turn order, O(1) */
+    std::size_t                 nextAlive(std::size_t seat) const { return next_.at(seat); }
+    std::size_t                 prevAlive(std::size_t seat) const { return prev_.at(seat); }
     std::size_t                 turnIndex()  const { return turnIdx_; }
     std::size_t                 tick()       const { return tick_; }
 
+    /* per-seat fields, without going through the Player */
+    int                         coins          (std::size_t seat) const { return coins_.at(seat); }
+    std::size_t                 lastArrested   (std::size_t seat) const { return lastArrested_.at(seat); }
+    std::size_t                 sanctionedUntil(std::size_t seat) const { return sanctionedUntil_.at(seat); }
+    bool                        sanctioned     (std::size_t seat) const { return sanctionedUntil_.at(seat) > tick_; }
 
+    /* the Tax / Bribe / Coup that may still be blocked, or nullptr */
+    const Action* blockable() const {
+        return pending_ ? &*pending_ : lastBlockable_ ? &lastBlockable_->act : nullptr;
+    }
+    const Action* pending()   const { return pending_ ? &*pending_ : nullptr; }
 
 
+
+
+    /* ---- plain-value copy of the whole table -------------- */
+    struct SeatState {
+        int         coins;
+        std::size_t lastArrested;
+        std::size_t sanctionedUntil;
+        bool        alive;
+    };
+    struct State {
+        std::vector<SeatState> seats;
+        std::size_t            turn{0}, tick{0};
+        std::optional<Action>  blockable;            // lastBlockable_
+        std::size_t            blockableExpires{0};
+        std::optional<Action>  pending;              // proposed, not yet committed
+    };
+    State state() const;
+    /* throws IllegalAction, table untouched, on a state it cannot be in:
+       another roster size, a dead or missing turn holder, or an open
+       action that is no Tax / Bribe / Coup by and on existing seats  */
+    void  load(const State& s);
+
+    /* ---- reversible moves for depth-first search -----------
+       make() plays `a` like perform / block and returns what it
+       overwrote; unmake() puts it back exactly (ring included).
+       Records must be undone in reverse order.  Neither one
+       allocates or notifies delta sinks.                        */
+    class UndoRecord {
+        friend class Game;
+        std::array<Touched,4>     seats_{};
+        std::size_t               nSeats_{0};
+        std::size_t               turn_{0}, tick_{0};
+        std::optional<Remembered> blockable_;
+        std::optional<Action>     pending_;
+    };
+    UndoRecord make  (const Action& a);  // throws like perform / block; state unchanged then
+    void       unmake(const UndoRecord& u);
+private:
+    /* performBatch scratch, reused between batches */
+    std::vector<UndoRecord> batchUndo_;
+    std::vector<Touched>    batchSeats_;
+public:
+
+    const Peek* lastPeek(std::size_t spy, std::size_t target) const;
+
+    /* ---- delta stream: one Delta per accepted action ------- */
+    using DeltaSink = std::function<void(const Delta&)>;
+    std::size_t subscribe  (DeltaSink sink);   // returns id for unsubscribe
+    void        unsubscribe(std::size_t id);
+
     /* ---- engine services ----------------------------------- */
-    std::size_t indexOf(const Player& p) const;
+    std::size_t indexOf(const Player& p) const;     // O(1) – the seat is kept in Player
 
-    void perform(const Action& a);     // do an action (Player wrappers call)
+    /* applies at once; a later block() reverts a Tax / Coup.  That
+       apply-then-revert is deprecated – it is kept for the Player
+       wrappers, whose callers block after the fact.  New drivers
+       use propose() / commit() below.                              */
+    void perform(const Action& a);
+    void perform(ActionCode c) { perform(c.decode()); }
+    /* all of `batch` (Blocks included) or none of it: on the first
+       rejection the table is rolled back and that exception rethrown.
+       Sinks get the net change once, at the end – one Delta unless it
+       spans more seats than a Delta has slots for.                    */
+    void performBatch(std::span<const Action> batch);
     void block  (const Action& b);     // Governor / Judge / General
+    void block  (ActionCode c) { block(c.decode()); }
+
+    /* ---- two-phase Tax / Bribe / Coup ----------------------
+       propose() checks the action and parks it – nothing changes yet.
+       A block() during the window discards it (a blocked Tax or Coup
+       still ends the turn, a blocked Coup still costs its 7 – as with
+       perform() then block()); commit() applies it once, after which it
+       can no longer be blocked – if rejected, the proposal is dropped and
+       the actor still holds the turn.
+       perform() is refused meanwhile.                                 */
+    void propose(const Action& a);
+    void commit ();
 
-    /* role-specific helpers (Spy, Baron, …) ------------------ */
+    /* role-specific helpers (Governor, Spy) ------------------ */
     void governorUndoTax(Player& gov, Player& taxed);
-    void baronInvest     (Player& baron);
-    void spyPeek         (Player& spy, Player& target);
+    int  spyPeek         (Player& spy, Player& target);
     void spyBlockArrest  (Player& spy, Player& target);
 };
 
@@ -0,0 +1,29 @@
+// thelet.shevach@gmail.com
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace coup {
+
+/* NameTable – every distinct name stored once, under a small id.  Ids
+   are dense from 0 in first-seen order; references returned by name()
+   stay valid for the table's lifetime.                                */
+class NameTable {
+public:
+    using Id = std::uint32_t;
+    static constexpr Id none = static_cast<Id>(-1);
+
+    Id                 intern(const std::string& name);    // existing id, or a new one
+    Id                 find  (const std::string& name) const;   // or none
+    const std::string& name  (Id id) const { return names_.at(id); }
+    std::size_t        size  () const { return names_.size(); }
+
+private:
+    std::deque<std::string>                 names_;    // deque: no moves on growth
+    std::unordered_map<std::string_view, Id> ids_;     // views into names_
+};
+
+} // namespace coup
@@ -16,13 +16,14 @@ namespace coup {
         Player& operator=(const Player&) = delete;
         virtual ~Player() = default;
 
-        // Accessors
-        const std::string& name()  const { return name_; }
-        int                coins() const { return coins_; }
+        // Accessors – coins, the other per-turn fields and the name live in Game
+        const std::string& name()  const;
+        int                coins() const;
+        std::size_t        seat()  const { return seat_; }
         virtual std::string role()  const = 0;
 
         // Game‐side coin bookkeeping
-        void addCoins(int c)   { coins_ += c; }
+        void addCoins(int c);
         void spendCoins(int c);
 
         // Actions (wrap Game::perform)
@@ -37,13 +38,10 @@ namespace coup {
         void onNewTurn();
 
         // Used internally by Game
-        std::size_t lastArrested_{static_cast<std::size_t>(-1)};
-        std::size_t sanctionedUntilTurn_{0};
+        std::size_t seat_{static_cast<std::size_t>(-1)};   // index in Game::roster()
 
     protected:
         Game&       game_;
-        std::string name_;
-        int         coins_{0};
     };
 
     // —— concrete roles ——
@@ -59,7 +57,7 @@ namespace coup {
     public:
         using Player::Player;
         std::string role() const override { return "Spy"; }
-        int  peek(Player& target)                { return target.coins(); }
+        int  peek(Player& target);
         void blockArrest(Player& target);
     };
 
@@ -6,15 +6,37 @@
 
 namespace coup_gui {
 
+/* Scrollable grid of player cards.  Only the rows inside the viewport
+   (plus one partly visible row) own a CardWidget; scrolling re-binds the
+   same cards to other seats, so a 500-seat table costs what 12 do.     */
 class BoardWidget {
 public:
-    explicit BoardWidget(const sf::Font&);
+    static constexpr float       kPitchX = 230, kPitchY = 320, kMargin = 10;
+    static constexpr std::size_t kClassicSeats = 6;     // a small table keeps six slots
+
+    BoardWidget(const sf::Font&, std::size_t seats, sf::Vector2f viewport = {800, 740});
+
+    std::size_t seats()        const { return seats_; }
+    std::size_t firstVisible() const { return firstRow_ * cols_; }
+    std::size_t endVisible()   const;                  // one past the last bound seat
+
+    /* the card showing `seat`, or nullptr while it is scrolled away */
+    CardWidget* card(std::size_t seat);
+
+    /* moves the view by dy pixels (clamped); true if other seats came
+       into view and need painting                                      */
+    bool scroll(float dy);
+    bool scrollTo(std::size_t seat);                   // bring `seat` into view
 
-    CardWidget& card(std::size_t i) { return *cards_.at(i); }
     void        draw(sf::RenderTarget&);
     void            handleClick(const sf::Event::MouseButtonEvent&, SFMLWindow&);
 private:
-    std::vector<std::unique_ptr<CardWidget>> cards_;
+    void layout();
+
+    std::vector<std::unique_ptr<CardWidget>> cards_;   // pool, bound to seats from firstVisible()
+    std::size_t seats_, cols_, rows_;
+    float       viewH_, scroll_{0};
+    std::size_t firstRow_{0};
 };
 
 } // namespace coup_gui
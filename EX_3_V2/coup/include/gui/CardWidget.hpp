@@ -17,10 +17,14 @@ public:
 
     Button& action(std::size_t i) { return buttons_.at(i); }
 
+    /* move the whole card – the board reuses cards while scrolling */
+    void place(sf::Vector2f topleft);
+
     void draw(sf::RenderTarget& rt);
     void handleClick(const sf::Event::MouseButtonEvent&, SFMLWindow&);
     
 private:
+    sf::Vector2f              pos_;
     sf::RectangleShape        panel_;
     sf::Text                  title_;
     sf::Text                  coins_;
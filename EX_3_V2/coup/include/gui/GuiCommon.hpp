@@ -30,6 +30,10 @@ struct Button {
         return shape.getGlobalBounds().contains(
             static_cast<float>(e.x), static_cast<float>(e.y));
     }
+    void move(float dx, float dy) {
+        shape.move(dx, dy);
+        label.move(dx, dy);
+    }
     void draw(sf::RenderTarget& rt) const {
         rt.draw(shape);
         rt.draw(label);
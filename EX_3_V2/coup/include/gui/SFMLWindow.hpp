@@ -10,17 +10,30 @@ namespace coup_gui {
 class SFMLWindow {
 public:
     explicit SFMLWindow(coup::Game& g);
+    ~SFMLWindow();
     int run(sf::RenderWindow& win);
 
+    /* draws one full frame into any target – the window in run(), or an
+       sf::RenderTexture when running headless (GuiBench, golden images) */
+    void renderFrame(sf::RenderTarget& rt);
+
+    /* scroll the board; large tables only lay out what is on screen */
+    void scroll(float dy);
+
 private:
     bool isSanctioned(const coup::Player&) const;
     void postMessage(const std::string&);
-    void updatePanels();
+    void updatePanels();                   // full repaint (first frame)
+    void paintCard(std::size_t seat);
+    void applyDelta(const coup::Delta&);   // repaint only what changed
 
     coup::Game&                  game_;
     sf::Font                     font_;
     std::unique_ptr<BoardWidget> board_;
     std::string                  message_;
+    std::size_t                  sinkId_;
+    std::size_t                  shownTurn_{0};
+    bool                         needsFull_{true};
 };
 
 } // namespace coup_gui
@@ -1,6 +1,7 @@
 // include/gui/StartScreen.hpp
 #pragma once
 #include <SFML/Graphics.hpp>
+#include <string>
 #include <vector>
 #include "gui/PlayerSpec.hpp"
 
@@ -8,6 +9,9 @@ namespace coup_gui {
 
 class StartScreen {
 public:
+    static constexpr int kMaxPlayers = 500;
+    static constexpr int kRows       = 9;                   // rows on screen
+
     explicit StartScreen(sf::RenderWindow& window);          // <- note
     std::vector<PlayerSpec> choose();                        // modal loop
 
@@ -15,17 +19,23 @@ private:
     sf::RenderWindow& win_;
     sf::Font          font_;
 
+    /* kRows on-screen widgets; row r shows seat firstRow_+r */
     struct Entry {
         sf::RectangleShape box;
         sf::Text           text;
-        bool               active{false};
     };
-    std::vector<Entry> nameBoxes_;
-    std::vector<Entry> roleBoxes_;
-    int                playerCount_{2};
+    std::vector<Entry>       nameBoxes_;
+    std::vector<Entry>       roleBoxes_;
+    std::vector<sf::Text>    seatLabels_;
+    std::vector<std::string> names_;                         // one per seat
+    std::vector<std::string> roles_;
+    int                      playerCount_{2};
+    int                      firstRow_{0};
+    int                      active_{-1};                    // seat being typed into
 
     void draw();
     void handleEvent(const sf::Event&);
+    void scrollRows(int d);
 };
 
 } // namespace coup_gui
@@ -0,0 +1,130 @@
+// thelet.shevach@gmail.com
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "sim/Simulator.hpp"
+#include "sim/Table.hpp"
+
+namespace coup_sim {
+
+constexpr std::size_t  kMaxRecordSeats = 16;   // roles / bots packed 4 bits per seat
+constexpr std::uint8_t kNoSeat         = 0xFF;
+
+/* GameRecord – one finished game, flattened to fixed-width fields */
+struct GameRecord {
+    std::uint64_t id{0};
+    std::uint32_t ticks{0};
+    std::uint8_t  players{0};
+    std::uint8_t  winnerSeat{kNoSeat};
+    std::uint8_t  winnerRole{kNoSeat};
+    std::array<std::uint16_t,kBlockKinds> blocks{};
+    std::uint64_t seatRoles{0};                // Role of seat i in bits 4i..4i+3
+    std::uint64_t seatBots{0};                 // bot index of seat i, same packing
+
+    Role        role(std::size_t seat) const { return static_cast<Role>(seatRoles >> (4*seat) & 0xF); }
+    std::size_t bot (std::size_t seat) const { return seatBots >> (4*seat) & 0xF; }
+};
+
+GameRecord makeRecord(std::uint64_t id, const std::vector<Role>& roles,
+                      const std::vector<std::size_t>& botIds, const GameResult& r);
+
+/* BalanceStats – per-thread accumulator; merge() is associative, so any
+   number of them can be folded together in any order.                  */
+struct BalanceStats {
+    static constexpr std::size_t kTickBucket  = 8;    // histogram width, ticks
+    static constexpr std::size_t kTickBuckets = 64;   // last bucket = overflow
+
+    std::uint64_t games{0}, draws{0};
+    std::array<std::uint64_t,kRoleCount>   seats{}, wins{};
+    std::array<std::uint64_t,kBlockKinds>  blocks{};
+    std::uint64_t ticksSum{0}, ticksMin{UINT64_MAX}, ticksMax{0};
+    std::array<std::uint64_t,kTickBuckets> tickHist{};
+
+    void          add  (const GameRecord& r);
+    void          merge(const BalanceStats& o);
+    double        winRate(Role r) const;             // wins / seats played
+    std::uint64_t tickPercentile(double p) const;    // upper edge of the bucket
+
+    /* roles.csv, lengths.csv, blocks.csv under `dir` */
+    void writeCsv(const std::string& dir) const;
+};
+
+/* RowGroup – a bounded batch of records stored column by column */
+struct RowGroup {
+    static constexpr std::size_t kRows = 4096;
+
+    std::vector<std::uint64_t> id;
+    std::vector<std::uint32_t> ticks;
+    std::vector<std::uint8_t>  players, winnerSeat, winnerRole;
+    std::vector<std::uint16_t> blockTax, blockBribe, blockCoup;
+    std::vector<std::uint64_t> seatRoles, seatBots;
+
+    void        push (const GameRecord& r);
+    GameRecord  row  (std::size_t i) const;
+    std::size_t size () const { return id.size(); }
+    bool        full () const { return size() >= kRows; }
+    void        clear();
+
+    /* f(name, column) for every column, in file order */
+    template<class F> void forEachColumn(F&& f) {
+        f("id",id); f("ticks",ticks); f("players",players);
+        f("winner_seat",winnerSeat); f("winner_role",winnerRole);
+        f("block_tax",blockTax); f("block_bribe",blockBribe); f("block_coup",blockCoup);
+        f("seat_roles",seatRoles); f("seat_bots",seatBots);
+    }
+};
+
+/* Columnar file: "COUPCOL1", u32 column count, per column (u8 name length,
+   name, u8 width), then row groups: u32 rows followed by each column's
+   values back to back.  Little-endian, as written by the host.         */
+class ColumnarWriter {
+public:
+    explicit ColumnarWriter(const std::string& path);   // throws std::runtime_error
+    ~ColumnarWriter();
+    ColumnarWriter(const ColumnarWriter&) = delete;
+    ColumnarWriter& operator=(const ColumnarWriter&) = delete;
+
+    void write(RowGroup& g);                            // thread-safe
+private:
+    std::FILE* f_;
+    std::mutex m_;
+};
+
+class ColumnarReader {
+public:
+    explicit ColumnarReader(const std::string& path);   // throws std::runtime_error
+    ~ColumnarReader();
+    ColumnarReader(const ColumnarReader&) = delete;
+    ColumnarReader& operator=(const ColumnarReader&) = delete;
+
+    bool next(RowGroup& g);                             // false at end of file
+private:
+    std::FILE* f_;
+};
+
+/* ── the pipeline ─────────────────────────────────────────── */
+class ArchiveWriter;
+
+struct StudyConfig {
+    std::uint64_t            games{10000};
+    unsigned                 threads{1};
+    std::size_t              minPlayers{2}, maxPlayers{6};
+    std::vector<std::string> bots{"random", "greedy"};   // drawn per seat
+    std::uint64_t            seed{1};
+    std::size_t              maxTicks{500};
+};
+
+/* Plays cfg.games random tables on cfg.threads workers.  Every worker folds
+   results into its own BalanceStats and RowGroup; full row groups stream to
+   `out` (if given) and the stats are merged once at the end.  Game ids are
+   handed out in blocks, and each game's seed depends only on its id, so the
+   totals do not depend on the thread count.  With `archive`, every block
+   of ids is also logged move by move and written as one archive block.  */
+BalanceStats runBalanceStudy(const StudyConfig& cfg, ColumnarWriter* out = nullptr,
+                             ArchiveWriter* archive = nullptr);
+
+} // namespace coup_sim
@@ -0,0 +1,104 @@
+// thelet.shevach@gmail.com
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "core/Action.hpp"
+#include "sim/Simulator.hpp"
+#include "sim/Table.hpp"
+
+namespace coup_sim {
+
+/* one game as played: seat roles, the winner and every accepted action */
+struct ArchivedGame {
+    std::uint64_t             id{0};
+    std::vector<Role>         roles;
+    std::size_t               winner{GameResult::noWinner};
+    std::vector<coup::Action> actions;
+};
+
+/* Replay archive: "COUPARC1", blocks, footer.
+
+   A block holds games with increasing ids:  varint games, then per game
+   varint id delta (from the block's first id, then from the previous
+   game), varint players, roles 4 bits each, varint winner+1 (0 = draw),
+   varint actions, varint payload bytes and the payload – each action
+   bit-packed as 4 bits type, actor and, for Arrest / Sanction / Coup /
+   SpyPeek, the target, seats taking ceil(log2 players) bits.  That is
+   5–10 bits per action on 2–6 seat tables; targets of other types are
+   not kept.
+
+   Footer: per block u64 first id, u64 last id, u64 offset, u32 games,
+   u32 bytes, sorted by first id; then u64 blocks, u64 footer offset and
+   "COUPARCF".  Blocks must cover disjoint id ranges.                      */
+class ArchiveWriter {
+public:
+    explicit ArchiveWriter(const std::string& path, std::size_t gamesPerBlock = 64);   // throws std::runtime_error
+    ~ArchiveWriter();                                      // close()s, swallowing errors
+    ArchiveWriter(const ArchiveWriter&)            = delete;
+    ArchiveWriter& operator=(const ArchiveWriter&) = delete;
+
+    /* single producer: ids must increase; blocks are cut every gamesPerBlock */
+    void add(const ArchivedGame& g);                       // throws std::invalid_argument
+    /* any thread: `games` (increasing ids) becomes one block of its own */
+    void writeBlock(const std::vector<ArchivedGame>& games);
+    void close();                                          // flush + footer; idempotent
+
+private:
+    struct BlockRef { std::uint64_t first, last, offset; std::uint32_t games, bytes; };
+
+    std::FILE*                f_{nullptr};
+    std::size_t               perBlock_;
+    std::vector<ArchivedGame> open_;                       // add()'s current block
+    std::vector<BlockRef>     blocks_;
+    std::uint64_t             offset_{0};
+    std::mutex                m_;
+};
+
+/* read-only mmap of an archive: lookups by id and full scans */
+class ArchiveReader {
+public:
+    explicit ArchiveReader(const std::string& path);       // throws std::runtime_error
+    ~ArchiveReader();
+    ArchiveReader(const ArchiveReader&)            = delete;
+    ArchiveReader& operator=(const ArchiveReader&) = delete;
+
+    std::uint64_t games()  const { return games_; }
+    std::size_t   blocks() const { return index_.size(); }
+    std::size_t   bytes()  const { return bytes_; }
+
+    bool find(std::uint64_t id, ArchivedGame& out) const;  // false if absent
+
+    /* f(const ArchivedGame&) for every game in id order; one ArchivedGame
+       is reused throughout, so copy what must outlive the call           */
+    template<class F> void scan(F&& f) const {
+        ArchivedGame g;
+        for(std::size_t b=0;b<index_.size();++b) {
+            const unsigned char* p   = base_ + index_[b].offset;
+            const unsigned char* end = p + index_[b].bytes;
+            const std::uint64_t  n   = readVarint(p, end);
+            g.id = index_[b].first;
+            for(std::uint64_t k=0;k<n;++k) { decode(p, end, g, true); f(static_cast<const ArchivedGame&>(g)); }
+        }
+    }
+
+private:
+    struct BlockRef { std::uint64_t first, last, offset; std::uint32_t games, bytes; };
+
+    /* both throw std::runtime_error rather than read past `end` (the block's end) */
+    static std::uint64_t readVarint(const unsigned char*& p, const unsigned char* end);
+    /* decodes the game at p into g (g.id: the block's first id before its
+       first game, the previous id after) and advances p; the actions are
+       only unpacked when `actions` is set.  Seat counts outside 2..16,
+       unknown roles or action types and seats past the table throw.     */
+    static void decode(const unsigned char*& p, const unsigned char* end, ArchivedGame& g, bool actions);
+
+    const unsigned char*  base_{nullptr};
+    std::size_t           bytes_{0};
+    std::uint64_t         games_{0};
+    std::vector<BlockRef> index_;
+};
+
+} // namespace coup_sim
@@ -0,0 +1,61 @@
+// thelet.shevach@gmail.com
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace coup_sim {
+
+/* Bitmap – compressed set of 32-bit ids, Roaring style.  Ids are split on
+   their high 16 bits into chunks; a chunk holding up to 4096 ids is a
+   sorted array of the low halves (≤ 8 KiB), a fuller one a 65536-bit
+   bitset (8 KiB).  Set operations work chunk by chunk, pairing the two
+   kinds with merge, probe or word-wise loops as fits.                   */
+class Bitmap {
+public:
+    static constexpr std::uint32_t kArrayMax = 4096;
+
+    void          add(std::uint32_t v);            // O(1) when v is the largest so far
+    bool          contains(std::uint32_t v) const;
+    std::uint64_t size()  const;
+    bool          empty() const { return chunks_.empty(); }
+
+    /* f(id) for every id, ascending */
+    template<class F> void forEach(F&& f) const {
+        for(const Chunk& c : chunks_) {
+            const std::uint32_t hi = std::uint32_t{c.key} << 16;
+            if(c.words.empty()) { for(std::uint16_t lo : c.ids) f(hi | lo); continue; }
+            for(std::uint32_t w=0; w<kWords; ++w)
+                for(std::uint64_t bits = c.words[w]; bits; bits &= bits - 1)
+                    f(hi | w << 6 | static_cast<std::uint32_t>(__builtin_ctzll(bits)));
+        }
+    }
+    std::vector<std::uint32_t> ids() const;
+
+    /* every id in [0, n) */
+    static Bitmap range(std::uint32_t n);
+
+    friend Bitmap operator&(const Bitmap& a, const Bitmap& b);
+    friend Bitmap operator|(const Bitmap& a, const Bitmap& b);
+    friend Bitmap operator-(const Bitmap& a, const Bitmap& b);   // a AND NOT b
+    bool operator==(const Bitmap&) const = default;
+
+private:
+    static constexpr std::uint32_t kWords = 1024;
+
+    struct Chunk {
+        std::uint16_t              key{0};
+        std::uint32_t              count{0};
+        std::vector<std::uint16_t> ids;            // array chunk, sorted
+        std::vector<std::uint64_t> words;          // bitset chunk (kWords) when non-empty
+        bool operator==(const Chunk&) const = default;
+    };
+    enum class Op { And, Or, AndNot };
+
+    static Chunk combine(const Chunk& a, const Chunk& b, Op op);
+    static void  toBitset(Chunk& c);
+    static void  shrink  (Chunk& c);               // back to an array when sparse
+
+    std::vector<Chunk> chunks_;                    // sorted by key, none empty
+};
+
+} // namespace coup_sim
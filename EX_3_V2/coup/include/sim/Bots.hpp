@@ -0,0 +1,49 @@
+// thelet.shevach@gmail.com
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include "core/Action.hpp"
+#include "core/Game.hpp"
+#include "sim/Rng.hpp"
+
+namespace coup_sim {
+
+/* Bot – decision policy for one seat.  The simulator asks choose() on the
+   bot's turn and react() whenever it could block Game::blockable().      */
+class Bot {
+public:
+    virtual ~Bot() = default;
+    virtual std::string name() const = 0;
+
+    /* pick one of `moves` (never empty) for the turn holder */
+    virtual coup::Action choose(const coup::Game& g,
+                                const std::vector<coup::Action>& moves, Rng& rng) = 0;
+    /* `seat` is allowed to block g.blockable(); true = block it */
+    virtual bool react(const coup::Game& g, std::size_t seat, Rng& rng) = 0;
+};
+
+/* uniform over legal moves, blocks with a fixed probability */
+class RandomBot : public Bot {
+public:
+    explicit RandomBot(double blockRate = 0.5) : blockRate_(blockRate) {}
+    std::string  name() const override { return "random"; }
+    coup::Action choose(const coup::Game&, const std::vector<coup::Action>&, Rng&) override;
+    bool         react (const coup::Game&, std::size_t, Rng&) override;
+private:
+    double blockRate_;
+};
+
+/* coup the richest rival when possible, otherwise the best coin move;
+   always blocks                                                        */
+class GreedyBot : public Bot {
+public:
+    std::string  name() const override { return "greedy"; }
+    coup::Action choose(const coup::Game&, const std::vector<coup::Action>&, Rng&) override;
+    bool         react (const coup::Game&, std::size_t, Rng&) override { return true; }
+};
+
+/* "random" / "greedy" / "ismcts"; throws std::invalid_argument otherwise */
+std::unique_ptr<Bot> makeBot(const std::string& name);
+
+} // namespace coup_sim
@@ -0,0 +1,92 @@
+// thelet.shevach@gmail.com
+#pragma once
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "core/Game.hpp"
+#include "sim/Bots.hpp"
+
+namespace coup_sim {
+
+/* Reaction information set – 12 bits of what the reacting seat can see:
+   bits 0-1  what to block (Tax / Bribe / Coup)
+   bits 2-4  own coins      (0 | 1-2 | 3-4 | 5-6 | 7-9 | 10+)
+   bits 5-7  game phase     (own turns so far: 0-1 | 2-3 | 4-6 | 7-10 | 11+)
+   bits 8-10 living players (2 … 6+)
+   bit  11   the reactor is the coup victim (a General may buy back
+             their own seat)                                             */
+constexpr std::size_t kReactionKeys = 1u << 12;
+std::uint16_t reactionKey(const coup::Game& g, std::size_t reactor);
+
+/* ReactionTable – the compact strategy: P(block) per information set,
+   one byte each (4 KiB).  Lookup is one index.                         */
+class ReactionTable {
+public:
+    ReactionTable() { prob_.fill(128); }
+
+    double blockProb(std::uint16_t key) const { return prob_[key] / 255.0; }
+    void   setBlockProb(std::uint16_t key, double p);
+    bool   decide(const coup::Game& g, std::size_t reactor, Rng& rng) const {
+        return rng.uniform() < blockProb(reactionKey(g, reactor));
+    }
+
+    void save(const std::string& path) const;    // throws std::runtime_error
+    void load(const std::string& path);
+private:
+    std::array<std::uint8_t,kReactionKeys> prob_;
+};
+
+/* CfrBot – moves like `inner`, reacts from a ReactionTable */
+class CfrBot : public Bot {
+public:
+    CfrBot(Bot& inner, const ReactionTable& table) : inner_(inner), table_(table) {}
+    std::string  name() const override { return "cfr+" + inner_.name(); }
+    coup::Action choose(const coup::Game& g, const std::vector<coup::Action>& m, Rng& r) override {
+        return inner_.choose(g, m, r);
+    }
+    bool react(const coup::Game& g, std::size_t seat, Rng& r) override { return table_.decide(g, seat, r); }
+private:
+    Bot&                 inner_;
+    const ReactionTable& table_;
+};
+
+struct CfrConfig {
+    unsigned      threads{1};
+    std::uint64_t windows{20000};      // reaction windows to train on, all threads
+    std::size_t   rollouts{4};         // per action value estimate
+    std::size_t   epoch{256};          // windows between merges into the shared table
+    std::size_t   minPlayers{2}, maxPlayers{6};
+    std::size_t   maxTicks{500};
+    std::uint64_t seed{1};
+};
+
+/* Outcome-sampled CFR+ over reaction windows.  Windows come from simulated
+   games (greedy / random movers); for each eligible reactor both choices
+   are valued by rollouts in which the other reactors and all later
+   reactions follow the current strategy.  Threads keep private regret and
+   average-strategy deltas and fold them into the shared table every
+   `epoch` windows (CFR+: regrets floored at 0, linear averaging).       */
+class CfrTrainer {
+public:
+    explicit CfrTrainer(const CfrConfig& cfg);   // throws std::invalid_argument
+
+    void          train();
+    ReactionTable averageStrategy() const;
+    std::uint64_t visits(std::uint16_t key) const { return visits_[key]; }
+
+private:
+    struct Local;
+    void worker(unsigned w, std::uint64_t windows);
+    void merge(Local& l);
+
+    CfrConfig                  cfg_;
+    std::vector<double>        regret_, average_;   // [key*2 + block?]
+    std::vector<std::uint64_t> visits_;
+    ReactionTable              current_;            // regret matching, shared snapshot
+    std::uint64_t              round_{0};
+    std::mutex                 m_;
+};
+
+} // namespace coup_sim
@@ -0,0 +1,108 @@
+// thelet.shevach@gmail.com
+#pragma once
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include "core/Game.hpp"
+#include "sim/Bots.hpp"
+#include "sim/Rng.hpp"
+#include "sim/Table.hpp"
+
+namespace coup_sim {
+
+/* Feature row, seen from one seat.  For the viewer and the next
+   kEvalSeats-1 seats in turn order (11 floats each):
+     alive, coins/10, role one-hot ×6, sanctioned,
+     viewer may not arrest this seat, seats until this seat's turn / n
+   then globals: living share, the viewer's / someone else's action
+   can still be blocked, tick/100 (≤1).
+   Padded with zeros to a multiple of 8 floats for the AVX2 kernels.    */
+constexpr std::size_t kEvalSeats    = 6;
+constexpr std::size_t kSeatFeatures = 11;
+constexpr std::size_t kFeatures     = 72;
+
+void extractFeatures(const coup::Game::State& s, const std::vector<Role>& roles,
+                     std::size_t seat, float* out);
+void extractFeatures(const coup::Game& g, std::size_t seat, float* out);
+
+/* FeatureBatch – 32-byte aligned rows of kFeatures floats, allocated once */
+class FeatureBatch {
+public:
+    explicit FeatureBatch(std::size_t capacity);
+
+    float*       push()                    { return rows_.get() + kFeatures * size_++; }
+    float*       row(std::size_t i)        { return rows_.get() + kFeatures * i; }
+    const float* data() const              { return rows_.get(); }
+    std::size_t  size() const              { return size_; }
+    std::size_t  capacity() const          { return capacity_; }
+    bool         full() const              { return size_ == capacity_; }
+    void         clear()                   { size_ = 0; }
+private:
+    struct Free { void operator()(float* p) const { std::free(p); } };
+    std::unique_ptr<float[], Free> rows_;
+    std::size_t                    size_{0}, capacity_;
+};
+
+/* EvalModel – P(win) for the viewer of a feature row.
+   Linear: sigmoid(lin·x + linB).
+   Mlp:    sigmoid(w2·relu(W1ᵀx + b1) + b2), kHidden units.
+   evaluate() uses AVX2+FMA when the CPU has them (checked once at run
+   time), otherwise the scalar reference; neither allocates.             */
+class EvalModel {
+public:
+    enum class Kind : std::uint8_t { Linear, Mlp };
+    static constexpr std::size_t kHidden = 32;
+
+    explicit EvalModel(Kind k = Kind::Mlp);
+
+    Kind kind() const { return kind_; }
+    void randomize(Rng& rng, float scale = 0.1f);
+
+    void  evaluate      (const float* rows, std::size_t n, float* out) const;
+    void  evaluateScalar(const float* rows, std::size_t n, float* out) const;
+    float evaluate1     (const float* row) const { float v; evaluate(row, 1, &v); return v; }
+
+    void save(const std::string& path) const;        // throws std::runtime_error
+    void load(const std::string& path);
+
+    /* parameters – public so trainers can step them */
+    alignas(32) float w1[kFeatures * kHidden];       // [input * kHidden + unit]
+    alignas(32) float b1[kHidden];
+    alignas(32) float w2[kHidden];
+    float             b2{0};
+    alignas(32) float lin[kFeatures];
+    float             linB{0};
+
+private:
+    Kind kind_;
+};
+
+/* EvalBot – one-ply lookahead: plays each legal move (or the block) on a
+   scratch copy of the table and keeps the one the model rates best for
+   its own seat; with probability `epsilon` it moves at random instead.
+   It reads the full state, so it is a perfect-information player.       */
+class EvalBot : public Bot {
+public:
+    explicit EvalBot(std::shared_ptr<const EvalModel> model, double epsilon = 0.0)
+        : model_(std::move(model)), epsilon_(epsilon) {}
+
+    std::string  name() const override { return "eval"; }
+    coup::Action choose(const coup::Game&, const std::vector<coup::Action>&, Rng&) override;
+    bool         react (const coup::Game&, std::size_t, Rng&) override;
+
+    void setModel(std::shared_ptr<const EvalModel> model) { model_ = std::move(model); }
+
+private:
+    coup::Game& scratch(const coup::Game& g);        // reset to g's state
+
+    std::shared_ptr<const EvalModel> model_;
+    double                           epsilon_;
+    std::vector<Role>                roles_;
+    std::unique_ptr<Table>           table_;
+    FeatureBatch                     batch_{32};
+    std::vector<float>               value_;
+};
+
+} // namespace coup_sim
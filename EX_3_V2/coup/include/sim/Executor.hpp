@@ -0,0 +1,132 @@
+// thelet.shevach@gmail.com
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "core/Action.hpp"
+#include "core/Game.hpp"
+#include "sim/MpscRing.hpp"
+#include "sim/Table.hpp"
+#include "sim/TimingWheel.hpp"
+
+namespace coup_sim {
+
+/* TableExecutor – actor-style owner of many tables.  Each table has its own
+   bounded MpscRing inbox; any thread may post to it, and only the executor
+   thread ever touches the Game, so commands to one table run one at a time
+   in posting order without a mutex.  A table with mail sits once in a
+   shared ready ring, so idle tables cost nothing per pass.
+
+   Tables are adopted before start().  run() drives the executor from the
+   calling thread instead (tests, single-threaded hosts) – never both.
+
+   Turn clock: with setTimers(), every table carries one TimingWheel timer
+   for its current turn (or open proposal).  It is re-armed only when the
+   table's tick or proposal changes, so idle tables cost nothing per tick;
+   on expiry the executor plays the default move (Gather when legal,
+   otherwise the first legal move) or commits the unanswered proposal.    */
+class TableExecutor {
+public:
+    using Command = std::function<void(coup::Game&)>;
+
+    struct TurnTimers {                                    // 0 disables a timer
+        std::chrono::milliseconds turn{0};                // no move in time → default move
+        std::chrono::milliseconds reaction{0};            // proposal unanswered → commit()
+        std::chrono::milliseconds tick{10};               // wheel resolution
+    };
+
+    explicit TableExecutor(std::size_t inboxCapacity = 1024);
+    ~TableExecutor();                                     // stop()s
+    TableExecutor(const TableExecutor&)            = delete;
+    TableExecutor& operator=(const TableExecutor&) = delete;
+
+    std::size_t  adopt(Table t);                          // → table id
+    std::size_t  size() const { return cells_.size(); }
+    const Table& table(std::size_t id) const { return cells_.at(id)->table; }   // while stopped
+
+    /* one executor thread; `onThread` runs on it first (pinning etc.) */
+    void start(std::function<void()> onThread = {});
+    void stop();                                           // finishes queued mail first
+
+    /* while stopped: commands a table has run since it was adopted, and
+       handing every table back in id order (the executor is then empty)  */
+    std::uint64_t      executed(std::size_t id) const { return cells_.at(id)->executed; }
+    std::vector<Table> release();
+
+    /* while stopped; arms every table.  The executor thread follows the
+       steady clock; in run() mode advanceClock() moves time on instead. */
+    void          setTimers(TurnTimers t);
+    std::size_t   advanceClock(std::chrono::milliseconds elapsed);   // → timers fired
+    std::uint64_t timeouts() const { return timeouts_; }             // clock moves played
+
+    /* drain ready tables from this thread; returns commands run */
+    std::size_t run(std::size_t budget = static_cast<std::size_t>(-1));
+
+    /* raw command; false when the table's inbox is full */
+    bool post(std::size_t id, Command cmd);
+
+    /* Game::perform, or Game::block for a Block; the future carries the
+       engine's exception if the action is rejected                    */
+    std::future<void> perform(std::size_t id, const coup::Action& a);
+
+    /* f(const Game&) on the executor, result through the future – e.g.
+       query(id, [](const coup::Game& g){ return g.players(); })          */
+    template<class F>
+    auto query(std::size_t id, F f) -> std::future<std::invoke_result_t<F&, const coup::Game&>> {
+        using R = std::invoke_result_t<F&, const coup::Game&>;
+        auto p = std::make_shared<std::promise<R>>();
+        auto fut = p->get_future();
+        const bool ok = post(id, [p, f = std::move(f)](coup::Game& g) mutable {
+            try {
+                if constexpr(std::is_void_v<R>) { f(std::as_const(g)); p->set_value(); }
+                else                            p->set_value(f(std::as_const(g)));
+            } catch(...) { p->set_exception(std::current_exception()); }
+        });
+        if(!ok) p->set_exception(std::make_exception_ptr(std::runtime_error("table inbox full")));
+        return fut;
+    }
+
+private:
+    struct Cell {
+        Table              table;
+        MpscRing<Command>  inbox;
+        std::atomic<bool>  scheduled{false};              // sits in ready_
+        std::uint64_t      executed{0};                   // executor thread only
+        TimingWheel::TimerId timer{TimingWheel::none};
+        std::uint64_t      armedFor{0};                   // clock key the timer belongs to
+        Cell(Table t, std::size_t cap) : table(std::move(t)), inbox(cap) {}
+    };
+
+    std::size_t drain(std::size_t id, std::size_t budget);
+    void        wake();
+    void        loop();
+    bool        timed() const { return timers_.turn.count() || timers_.reaction.count(); }
+    void        rearm (std::size_t id);                    // after the table changed
+    void        expire(std::size_t id);                    // its timer fired
+
+    std::size_t                        inboxCapacity_;
+    std::vector<std::unique_ptr<Cell>> cells_;
+    std::unique_ptr<MpscRing<std::size_t>> ready_;        // ids of tables with mail
+    std::thread                        thread_;
+    std::atomic<bool>                  running_{false};
+    std::atomic<bool>                  sleeping_{false};
+    std::atomic<std::uint32_t>         signal_{0};
+    std::mutex                         sleepM_;
+    std::condition_variable            sleepCv_;
+
+    TurnTimers                         timers_;
+    TimingWheel                        wheel_;            // executor thread only
+    std::uint64_t                      timeouts_{0};
+};
+
+} // namespace coup_sim
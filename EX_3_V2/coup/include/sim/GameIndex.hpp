@@ -0,0 +1,61 @@
+// thelet.shevach@gmail.com
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "core/Action.hpp"
+#include "sim/Archive.hpp"
+#include "sim/Bitmap.hpp"
+#include "sim/Simulator.hpp"
+#include "sim/Table.hpp"
+
+namespace coup_sim {
+
+/* Event – one fact a game either has or has not.  "a seat with role R"
+   means any seat dealt R; several seats may share a role.               */
+struct Event {
+    std::uint32_t key;
+
+    static Event winner  (Role r);                             // R's seat won
+    static Event draw    ();                                   // nobody won
+    static Event seated  (Role r);                             // R was dealt
+    static Event did     (Role r, coup::Action::Type t);       // R's seat made an accepted t
+    static Event blocked (Role r, BlockKind k);                // R's seat blocked a Tax / Bribe / Coup
+    /* R's seat was the target of t at least `times` (1..3) times */
+    static Event targeted(Role r, coup::Action::Type t, unsigned times = 1);
+    static Event winnerDid    (coup::Action::Type t);          // the winning seat made a t
+    static Event winnerBlocked(BlockKind k);                   // the winning seat blocked a k
+
+    static constexpr std::uint32_t kTypes   = 9;               // Action::Type values
+    static constexpr std::uint32_t kPerRole = 2 + kTypes + kBlockKinds + kTypes * 3;
+    static constexpr std::uint32_t kKeys    = kRoleCount * kPerRole + 1 + kTypes + kBlockKinds;
+};
+
+/* GameIndex – one Bitmap of game ids per Event, built by a single pass over
+   an archive.  Queries combine them with &, | and - (AND NOT), and with
+   except() for NOT, so a question costs a few chunk-wise bitmap ops rather
+   than replaying games:
+
+       // a General blocked a coup and then won
+       idx[Event::winner(Role::General)] & idx[Event::winnerBlocked(BlockCoup)]
+       // a Merchant was arrested three times, and no Judge was dealt
+       idx[Event::targeted(Role::Merchant, Type::Arrest, 3)] - idx[Event::seated(Role::Judge)]
+
+   Game ids must fit in 32 bits.                                          */
+class GameIndex {
+public:
+    GameIndex() : sets_(Event::kKeys) {}
+    explicit GameIndex(const ArchiveReader& r);
+
+    /* ids in increasing order are cheapest; throws std::invalid_argument on ids ≥ 2^32 */
+    void add(const ArchivedGame& g);
+
+    const Bitmap& operator[](Event e) const { return sets_[e.key]; }
+    const Bitmap& all() const { return all_; }
+    Bitmap except(const Bitmap& b) const { return all_ - b; }   // NOT, within the indexed games
+
+private:
+    std::vector<Bitmap> sets_;
+    Bitmap              all_;
+};
+
+} // namespace coup_sim
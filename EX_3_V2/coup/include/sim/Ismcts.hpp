@@ -0,0 +1,51 @@
+// thelet.shevach@gmail.com
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "sim/Bots.hpp"
+#include "sim/Eval.hpp"
+#include "sim/Observation.hpp"
+
+namespace coup_sim {
+
+struct IsmctsConfig {
+    unsigned    threads{1};
+    std::size_t iterations{4000};     // per thread
+    double      budgetMs{30.0};       // whichever runs out first
+    double      exploration{0.7};     // UCB constant
+    std::size_t rolloutDepth{60};     // actions, then the heuristic scores
+    const EvalModel* eval{nullptr};   // scores cut-off rollouts instead of the coin share
+};
+
+/* Single-observer information-set MCTS.  Every iteration samples a
+   determinization of `obs`, descends a tree shared by all samples (a child
+   competes only in the samples where its move is legal – the availability
+   count), rolls out randomly and backs up, for every node, the reward of
+   the seat that moved into it.  A Tax / Bribe / Coup is proposed and the
+   opponents react to it at random before it is committed.
+   Root moves are generated per sample as well: whether an Arrest is legal
+   depends on the target's hidden coins, so the real `rootMoves` would
+   leak them.  Each thread grows its own tree; root statistics are summed
+   and only then is the most visited of `rootMoves` returned.            */
+coup::Action ismctsSearch(const Observation& obs, const std::vector<coup::Action>& rootMoves,
+                          const IsmctsConfig& cfg, std::uint64_t seed);
+
+/* The reaction node of the same search: should `obs.seat` block
+   Game::blockable()?  Letting it stand and blocking are the two arms of
+   a UCB1 bandit; each pull is a fresh determinization, the answer (later
+   seats react randomly to a proposal let through), a random rollout and
+   the usual score.  One thread, the same iteration and time budget.    */
+bool ismctsReact(const Observation& obs, const IsmctsConfig& cfg, std::uint64_t seed);
+
+/* searches with what observe() gives it, for moves and reactions alike */
+class IsmctsBot : public Bot {
+public:
+    explicit IsmctsBot(const IsmctsConfig& cfg = {}) : cfg_(cfg) {}
+    std::string  name() const override { return "ismcts"; }
+    coup::Action choose(const coup::Game&, const std::vector<coup::Action>&, Rng&) override;
+    bool         react (const coup::Game&, std::size_t, Rng&) override;
+private:
+    IsmctsConfig cfg_;
+};
+
+} // namespace coup_sim
@@ -0,0 +1,34 @@
+// thelet.shevach@gmail.com
+#pragma once
+#include <vector>
+#include "core/Action.hpp"
+#include "core/Game.hpp"
+
+namespace coup_sim {
+
+/* Every move produced here is accepted by Game::perform / Game::block.
+   The generator is a little stricter than the engine: targets must be
+   other, living players and blockers must be alive.                    */
+
+/* moves open to the current turn holder (appends to `out`); the
+   ActionCode forms list the same moves in the same order, 2 bytes each */
+void legalMoves (const coup::Game& g, std::vector<coup::Action>& out);
+void legalMoves (const coup::Game& g, std::vector<coup::ActionCode>& out);
+
+/* Block actions open right now against Game::blockable() */
+void legalBlocks(const coup::Game& g, std::vector<coup::Action>& out);
+void legalBlocks(const coup::Game& g, std::vector<coup::ActionCode>& out);
+bool canBlock   (const coup::Game& g, std::size_t seat);
+
+/* Tax, Bribe and Coup – the moves that open a reaction window */
+inline bool blockable(coup::Action::Type t) {
+    return t == coup::Action::Type::Tax || t == coup::Action::Type::Bribe || t == coup::Action::Type::Coup;
+}
+
+/* Block → Game::block, everything else → Game::perform */
+void apply(coup::Game& g, const coup::Action& a);
+void apply(coup::Game& g, coup::ActionCode c);
+
+std::size_t aliveCount(const coup::Game& g);
+
+} // namespace coup_sim
@@ -0,0 +1,76 @@
+// thelet.shevach@gmail.com
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace coup_sim {
+
+/* MpscRing – bounded lock-free queue, many producers / one consumer.
+   Each slot carries a sequence number (Vyukov's bounded queue): a producer
+   claims a position with one CAS on tail_, fills the slot and publishes it
+   by bumping the slot's sequence; the consumer owns head_ outright.
+   Capacity is rounded up to a power of two.                             */
+template<class T>
+class MpscRing {
+public:
+    explicit MpscRing(std::size_t capacity) {
+        std::size_t n = 2;
+        while(n < capacity) n <<= 1;
+        mask_  = n - 1;
+        slots_ = std::make_unique<Slot[]>(n);
+        for(std::size_t i=0;i<n;++i) slots_[i].seq.store(i, std::memory_order_relaxed);
+    }
+    MpscRing(const MpscRing&)            = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    /* any thread; false when full */
+    bool push(T&& v) {
+        std::size_t pos = tail_.load(std::memory_order_relaxed);
+        for(;;) {
+            Slot& s = slots_[pos & mask_];
+            const std::size_t seq = s.seq.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+            if(diff == 0) {
+                if(tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    s.value = std::move(v);
+                    s.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if(diff < 0) {
+                return false;                              // a full lap behind the consumer
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /* consumer thread only */
+    bool pop(T& out) {
+        Slot& s = slots_[head_ & mask_];
+        if(s.seq.load(std::memory_order_acquire) != head_ + 1) return false;
+        out = std::move(s.value);
+        s.value = T{};                                     // drop captured state now
+        s.seq.store(head_ + mask_ + 1, std::memory_order_release);
+        ++head_;
+        return true;
+    }
+    bool empty() const {                                   // consumer thread only
+        return slots_[head_ & mask_].seq.load(std::memory_order_acquire) != head_ + 1;
+    }
+    std::size_t capacity() const { return mask_ + 1; }
+
+private:
+    struct Slot {
+        std::atomic<std::size_t> seq{0};
+        T                        value{};
+    };
+    std::unique_ptr<Slot[]>              slots_;
+    std::size_t                          mask_{0};
+    alignas(64) std::atomic<std::size_t> tail_{0};         // producers
+    alignas(64) std::size_t              head_{0};         // consumer
+};
+
+} // namespace coup_sim
@@ -0,0 +1,34 @@
+// thelet.shevach@gmail.com
+#pragma once
+#include <vector>
+#include "core/Game.hpp"
+#include "sim/Rng.hpp"
+#include "sim/Table.hpp"
+
+namespace coup_sim {
+
+constexpr int kHiddenCoins = -1;
+
+/* Observation – everything seat `seat` is entitled to know.  All of
+   Game::State is public at the table except the other players' coins:
+   those read kHiddenCoins, and a Spy additionally keeps the last value it
+   peeked (Game::lastPeek) with the number of ticks since.  Search code
+   works from an Observation only, never from the Game itself.          */
+struct Observation {
+    std::size_t              seat{0};
+    std::vector<Role>        roles;
+    coup::Game::State        state;
+    std::vector<int>         peeked;      // kHiddenCoins when never peeked
+    std::vector<std::size_t> peekAge;     // ticks since the peek
+};
+
+Observation observe(const coup::Game& g, std::size_t seat);
+
+/* One sample of the information set: hidden coins are drawn around the
+   peeked value (exact when peeked this tick) or from a prior that grows
+   with the seat's turns so far.  Samples stay below 10, since a seat
+   holding 10+ would have been forced to coup, and the actor of an open
+   Bribe or Coup proposal is drawn able to pay for it.                  */
+coup::Game::State determinize(const Observation& o, Rng& rng);
+
+} // namespace coup_sim
@@ -0,0 +1,35 @@
+// thelet.shevach@gmail.com
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "sim/Table.hpp"
+
+namespace coup_sim {
+
+struct PerftConfig {
+    std::vector<Role> roles;                 // seat i gets roles[i]
+    std::vector<int>  coins;                 // starting coins per seat; empty → all 0
+    unsigned          depth{4};
+    unsigned          threads{1};            // root moves are dealt round-robin
+    std::size_t       hashMb{0};             // per-thread transposition table; 0 → off
+};
+
+struct PerftResult {
+    std::vector<std::uint64_t> leaves;       // [d] = sequences of d+1 moves
+    std::uint64_t              nodes{0};     // moves generated
+    double                     seconds{0};
+};
+
+/* Perft – counts every sequence of legal actions from the setup, to each
+   depth up to cfg.depth.  A position's moves are the turn holder's
+   legalMoves plus every legalBlocks reaction open at that moment, so the
+   tree covers who may block as well as what is played.  Positions are
+   walked with Game::make / unmake on one table per thread.
+
+   With a hash table the walk is repeated per depth and subtree counts
+   are reused across transpositions; the state key leaves out the tick
+   (sanctions are kept relative to it), so the counts match the plain
+   walk exactly barring 64-bit key collisions.                          */
+PerftResult perft(const PerftConfig& cfg);    // throws std::invalid_argument on a bad setup
+
+} // namespace coup_sim
@@ -0,0 +1,70 @@
+// thelet.shevach@gmail.com
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "sim/Analytics.hpp"
+
+namespace coup_sim {
+
+enum class RatingModel : std::uint8_t { Elo, TrueSkill };
+
+struct RatingConfig {
+    RatingModel model{RatingModel::Elo};
+    double      eloK{24.0};               // K-factor of a single game
+    double      eloStart{1500.0};
+    double      mu0{25.0}, sigma0{25.0/3}, beta{25.0/6}, tau{25.0/300};
+    unsigned    threads{1};
+};
+
+/* Ratings – one entry per rated entity.  Elo only uses `mu`. */
+struct Ratings {
+    std::vector<double>        mu, sigma2;
+    std::vector<std::uint64_t> games;
+
+    std::size_t size() const { return mu.size(); }
+    double      conservative(std::size_t i) const;   // TrueSkill mu - 3 sigma
+};
+
+/* RatingEngine – rates bots (by GameRecord::bot index) and roles from
+   finished multiplayer games.  A game is the winner beating every other
+   seat; TrueSkill uses the pairwise winner-vs-loser approximation.  Draws
+   are skipped.
+
+   update() is the batched mode: every game in the batch is scored against
+   the ratings as they were when the batch started and only additive
+   statistics are collected, so worker threads sum them privately and the
+   sums are applied once.  Elo takes one damped Newton step on the batch
+   (≈ the classic K-factor update for a single game); TrueSkill multiplies
+   the per-game Gaussian messages, i.e. adds their natural parameters.
+   Neither overshoots however large the batch is.                        */
+class RatingEngine {
+public:
+    RatingEngine(std::size_t nBots, const RatingConfig& cfg);
+
+    void update(const std::vector<GameRecord>& batch);
+
+    const Ratings& bots()  const { return bots_; }
+    const Ratings& roles() const { return roles_; }
+    std::uint64_t  gamesSeen() const { return seen_; }
+
+    /* binary checkpoint; save writes a temp file and renames it over `path`,
+       load throws std::runtime_error on a missing or mismatching file     */
+    void saveCheckpoint(const std::string& path) const;
+    void loadCheckpoint(const std::string& path);
+
+private:
+    /* Elo: gradient / curvature of the log-likelihood.
+       TrueSkill: summed message precision-mean / precision.             */
+    struct Deltas { std::vector<double> a, b; std::vector<std::uint64_t> games; };
+
+    void scoreGame(const GameRecord& g, const Ratings& r, bool byRole, Deltas& d) const;
+    void apply(Ratings& r, const Deltas& d) const;
+    void reset(Deltas& d, std::size_t n) const;
+
+    RatingConfig  cfg_;
+    Ratings       bots_, roles_;
+    std::uint64_t seen_{0};
+};
+
+} // namespace coup_sim
@@ -0,0 +1,29 @@
+// thelet.shevach@gmail.com
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+namespace coup_sim {
+
+/* Rng – SplitMix64.  Tiny state, so every thread / simulated table can own
+   one; same seed → same game, which keeps simulations reproducible.      */
+struct Rng {
+    std::uint64_t state;
+
+    explicit Rng(std::uint64_t seed = 0x9E3779B97F4A7C15ull) : state(seed) {}
+
+    std::uint64_t next() {
+        std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    /* uniform in [0,n) */
+    std::size_t below(std::size_t n) {
+        return static_cast<std::size_t>((next() >> 32) * n >> 32);
+    }
+    /* uniform in [0,1) */
+    double uniform() { return (next() >> 11) * 0x1.0p-53; }
+};
+
+} // namespace coup_sim
@@ -0,0 +1,72 @@
+// thelet.shevach@gmail.com
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+#include "sim/Executor.hpp"
+
+namespace coup_sim {
+
+struct SchedulerConfig {
+    unsigned    workers{0};               // 0 → one per usable CPU
+    bool        pin{true};                // pin worker w to CPU cpus[w % cpus]
+    std::size_t inboxCapacity{1024};
+};
+
+/* Scheduler – shards tables across TableExecutor workers, one per core.
+
+   Memory placement without libnuma: every table is built (and, when it
+   moves, rebuilt) by a thread pinned to its worker's CPU.  Linux places
+   pages on the node that first touches them, and glibc hands each thread
+   its own malloc arena, so a worker's Games, rosters and Players live in
+   its own arena on its own node.
+
+   rebalance() runs at a quiescent point: it stops the workers, moves
+   tables from the busiest to the idlest worker by commands run since the
+   last rebalance, and restarts.  Table ids never change.                */
+class Scheduler {
+public:
+    explicit Scheduler(SchedulerConfig cfg = {});
+    ~Scheduler();
+    Scheduler(const Scheduler&)            = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    /* `make` runs on the worker's CPU at the next start() → table id */
+    std::size_t add(std::function<Table()> make);
+    std::size_t size()    const { return route_.size(); }
+    unsigned    workers() const { return static_cast<unsigned>(workers_.size()); }
+    unsigned    workerOf(std::size_t id) const { return route_.at(id).worker; }
+    int         cpuOf   (unsigned worker) const { return cpus_[worker % cpus_.size()]; }
+
+    void start();
+    void stop();
+    /* tables moved; callable running or stopped, leaves it as it was */
+    std::size_t rebalance();
+    /* commands per worker since the last rebalance */
+    std::vector<std::uint64_t> load() const;
+
+    bool              post   (std::size_t id, TableExecutor::Command cmd);
+    std::future<void> perform(std::size_t id, const coup::Action& a);
+    template<class F> auto query(std::size_t id, F f) {
+        const Route r = route_.at(id);
+        return workers_[r.worker]->query(r.local, std::move(f));
+    }
+
+private:
+    struct Route { unsigned worker; std::size_t local; };
+
+    void buildOn(unsigned worker, const std::function<void()>& job) const;   // on a pinned thread
+    void pinHere(unsigned worker) const;
+
+    SchedulerConfig                             cfg_;
+    std::vector<int>                            cpus_;
+    std::vector<std::unique_ptr<TableExecutor>> workers_;
+    std::vector<Route>                          route_;
+    std::vector<std::uint64_t>                  base_;        // executed() at the last rebalance, per id
+    std::vector<std::vector<std::pair<std::size_t, std::function<Table()>>>> pending_;   // per worker
+    bool                                        running_{false};
+};
+
+} // namespace coup_sim
@@ -0,0 +1,104 @@
+// thelet.shevach@gmail.com
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "sim/Eval.hpp"
+#include "sim/Rng.hpp"
+
+namespace coup_sim {
+
+/* ReplayBuffer – fixed-size ring of (features, outcome) records in a file.
+   Layout: "COUPRPL1", u32 kFeatures, u32 0, u64 capacity, u64 written,
+   then `capacity` records of kFeatures+1 floats.  Reopening a file with
+   the same shape resumes it; anything else is recreated.  Thread-safe.   */
+class ReplayBuffer {
+public:
+    ReplayBuffer(const std::string& path, std::size_t capacity);   // throws std::runtime_error
+    ~ReplayBuffer();
+    ReplayBuffer(const ReplayBuffer&)            = delete;
+    ReplayBuffer& operator=(const ReplayBuffer&) = delete;
+
+    /* n rows of kFeatures floats and n labels in [0,1] */
+    void append(const float* rows, const float* labels, std::size_t n);
+    /* n uniformly drawn records into `out` (n rows) and `labels`;
+       false while the buffer is empty                                    */
+    bool sample(Rng& rng, std::size_t n, FeatureBatch& out, float* labels);
+
+    std::uint64_t written()  const { return written_.load(); }
+    std::size_t   size()     const { return std::size_t(std::min<std::uint64_t>(written(), capacity_)); }
+    std::size_t   capacity() const { return capacity_; }
+    void          flush();
+
+private:
+    void writeHeader();
+
+    std::fstream               f_;
+    std::size_t                capacity_;
+    std::atomic<std::uint64_t> written_{0};
+    std::mutex                 m_;
+};
+
+struct SelfPlayConfig {
+    unsigned      actors{1};              // game-playing threads
+    unsigned      learners{1};            // SGD threads
+    std::size_t   games{2000};
+    std::size_t   steps{2000};            // minimum SGD steps in total
+    std::string   buffer{"replay.bin"};
+    std::size_t   capacity{1u << 18};     // records kept on disk
+    std::size_t   batch{256};
+    std::size_t   warmup{4096};           // records before learning starts
+    std::size_t   publishEvery{64};       // steps between model hand-offs to actors
+    double        lr{0.05};
+    double        l2{1e-5};
+    double        epsilon{0.1};           // EvalBot exploration
+    double        evalShare{0.5};         // seats driven by the current model
+    EvalModel::Kind kind{EvalModel::Kind::Mlp};
+    std::size_t   minPlayers{2}, maxPlayers{6};
+    std::size_t   maxTicks{500};
+    std::uint64_t seed{1};
+};
+
+struct SelfPlayStats {
+    std::uint64_t games{0};
+    std::uint64_t samples{0};
+    std::uint64_t steps{0};
+    double        loss{0};                // running mean log-loss of the last steps
+};
+
+/* SelfPlayTrainer – actors and learners in one process.
+   Actor threads deal random tables whose seats are EvalBots on the latest
+   published model or greedy/random bots, record every decision from the
+   mover's chair and, once the game ends, append them to the replay buffer
+   labelled 1 (won), 0 (lost) or the draw share.  Learner threads sample
+   minibatches, compute log-loss gradients against their own copy of the
+   model and fold them into the master under a lock.  The first exception
+   a thread throws stops the others and is rethrown from train().       */
+class SelfPlayTrainer {
+public:
+    explicit SelfPlayTrainer(const SelfPlayConfig& cfg, const EvalModel* start = nullptr);
+
+    SelfPlayStats train();
+    EvalModel     model() const;
+
+private:
+    void actor(unsigned w, std::size_t games);
+    void learner(unsigned w);
+    void step(EvalModel& grad, std::size_t n, double loss);   // under m_
+
+    SelfPlayConfig                   cfg_;
+    ReplayBuffer                     buffer_;
+    EvalModel                        master_;
+    std::shared_ptr<const EvalModel> published_;
+    SelfPlayStats                    stats_;
+    std::atomic<unsigned>            actorsLeft_{0};
+    std::atomic<bool>                stop_{false};
+    std::exception_ptr               error_;                   // under m_
+    mutable std::mutex               m_;
+};
+
+} // namespace coup_sim
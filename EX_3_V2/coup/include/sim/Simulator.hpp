@@ -0,0 +1,38 @@
+// thelet.shevach@gmail.com
+#pragma once
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "core/Game.hpp"
+#include "sim/Bots.hpp"
+#include "sim/Rng.hpp"
+
+namespace coup_sim {
+
+enum BlockKind : std::uint8_t { BlockTax, BlockBribe, BlockCoup, kBlockKinds };
+
+struct GameResult {
+    static constexpr std::size_t noWinner = static_cast<std::size_t>(-1);
+
+    std::size_t                           winner{noWinner};   // seat, or draw
+    std::size_t                           ticks{0};           // Game::tick() at the end
+    std::size_t                           actions{0};         // performs + blocks
+    std::array<std::uint32_t,kBlockKinds> blocks{};
+};
+
+/* Plays `g` to the end.  bots[i] drives seat i; a Tax / Bribe / Coup is
+   proposed and the other seats get a reaction window, in seat order from
+   the actor, before it is committed.  A game still running after `maxTicks` turns is a draw.
+   Every accepted move and block is appended to `log` when one is given. */
+GameResult playGame(coup::Game& g, const std::vector<Bot*>& bots, Rng& rng,
+                    std::size_t maxTicks = 2000, std::vector<coup::Action>* log = nullptr);
+
+/* Plays a playGame log back onto a fresh table the way it was played: a
+   Tax / Bribe / Coup is proposed, then blocked by the Block that follows
+   it or committed.  `before(a)` sees the table just ahead of each logged
+   action.  Throws like the engine on a log that does not fit the table. */
+void replayGame(coup::Game& g, const std::vector<coup::Action>& log,
+                const std::function<void(const coup::Action&)>& before = {});
+
+} // namespace coup_sim
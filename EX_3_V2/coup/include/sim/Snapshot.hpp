@@ -0,0 +1,97 @@
+// thelet.shevach@gmail.com
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "core/Action.hpp"
+#include "core/Game.hpp"
+#include "sim/Table.hpp"
+
+namespace coup_sim {
+
+/* Crash-safe persistence for many running tables: a periodic snapshot of
+   every Game::State plus an append-only tail of the actions accepted since.
+   Recovery = map the snapshot, rebuild each table, replay the tail.
+
+   Snapshot layout (host byte order):
+     "COUPSNP2", u64 tables, u64 tailMark, u64 payload bytes, u64 FNV-1a
+     of the payload, then per table
+       u32 seats, u32 turn, u32 tick, u32 blockableExpires,
+       u8 blockable type (0xFF = none), 3×u8 0, u32 actor, u32 target,
+       u8 pending type (0xFF = none), 3×u8 0, u32 actor, u32 target,
+       and per seat u8 role, u8 alive, 2×u8 0, i32 coins,
+       u32 lastArrested, u32 sanctionedUntil.
+   Seat numbers of "none" are stored as 0xFFFFFFFF.  The file is written
+   next to its destination, fsync'ed and renamed over it, so a crash leaves
+   either the old or the new snapshot – never a torn one.                 */
+
+/* `tables[i]` is saved as table i; `tailMark` is ActionTail::records() at
+   the moment of the snapshot (replay starts there).  Throws runtime_error. */
+void saveSnapshot(const std::string& path, const std::vector<const Table*>& tables,
+                  std::uint64_t tailMark = 0);
+
+/* read-only mmap of a snapshot; the checksum is verified on open */
+class SnapshotFile {
+public:
+    explicit SnapshotFile(const std::string& path);   // throws std::runtime_error
+    ~SnapshotFile();
+    SnapshotFile(const SnapshotFile&)            = delete;
+    SnapshotFile& operator=(const SnapshotFile&) = delete;
+
+    std::size_t   size()     const { return offsets_.size(); }
+    std::uint64_t tailMark() const { return tailMark_; }
+
+    std::vector<Role> roles(std::size_t i) const;
+    coup::Game::State state(std::size_t i) const;
+    Table             restore(std::size_t i) const;   // deal(roles) + load(state); IllegalAction if unfit
+    std::vector<Table> restoreAll() const;
+
+private:
+    const unsigned char*     base_{nullptr};
+    std::size_t              bytes_{0};
+    std::uint64_t            tailMark_{0};
+    std::vector<std::size_t> offsets_;                // table record starts
+};
+
+/* how a tail record is replayed: played through `apply`, parked with
+   Game::propose, or the open proposal committed.  A commit is logged even
+   when the table rejects it – the rejection still drops the proposal.    */
+enum class TailOp : std::uint8_t { Apply, Propose, Commit };
+
+struct TailRecord {
+    std::uint32_t table;
+    TailOp        op;
+    coup::Action  action;
+};
+
+/* ActionTail – append-only log of accepted actions: "COUPTAL1", then one
+   checksummed 24-byte record each: u32 table, u32 actor, u32 target, u8 type,
+   u8 op, 2×u8 0, u32 FNV-1a of the first 16 bytes, u32 0.  Opening an
+   existing tail drops a torn or corrupt suffix (a crash mid-append).    */
+class ActionTail {
+public:
+    explicit ActionTail(const std::string& path);     // throws std::runtime_error
+    ~ActionTail();
+    ActionTail(const ActionTail&)            = delete;
+    ActionTail& operator=(const ActionTail&) = delete;
+
+    void          append(std::uint32_t table, const coup::Action& a, TailOp op = TailOp::Apply);
+    void          sync();                             // fdatasync – durable up to here
+    std::uint64_t records() const { return records_; }
+
+    /* f(record) for every record from `from` on, in append order */
+    template<class F> void replay(std::uint64_t from, F&& f) const {
+        for(const TailRecord& r : read(from)) f(r);
+    }
+
+private:
+    std::vector<TailRecord> read(std::uint64_t from) const;
+
+    int           fd_{-1};
+    std::uint64_t records_{0};
+};
+
+/* snapshot + tail → running tables, open proposals included */
+std::vector<Table> recover(const std::string& snapshot, const std::string& tail);
+
+} // namespace coup_sim
@@ -0,0 +1,36 @@
+// thelet.shevach@gmail.com
+#pragma once
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "core/Game.hpp"
+#include "core/Player.hpp"
+
+namespace coup_sim {
+
+enum class Role : std::uint8_t { Governor, Spy, Baron, General, Judge, Merchant };
+constexpr std::size_t kRoleCount = 6;
+
+const char* roleName(Role r);
+Role        roleOf  (const coup::Player& p);
+
+std::unique_ptr<coup::Player> makePlayer(coup::Game& g, Role r, const std::string& name);
+
+/* Table – a Game plus the Player objects seated at it.  Game only keeps
+   raw pointers, so something has to own the players; the Game itself is
+   heap-held because every Player keeps a reference to it.              */
+struct Table {
+    std::unique_ptr<coup::Game>                game;
+    std::vector<std::unique_ptr<coup::Player>> seats;
+
+    /* seat i gets roles[i] and the name "P<i+1>" */
+    static Table deal(const std::vector<Role>& roles);
+
+    /* fresh objects with the same roles, names and Game::State – allocated
+       by the calling thread (delta sinks and spy peeks are not copied)    */
+    Table copy() const;
+};
+
+} // namespace coup_sim
@@ -0,0 +1,55 @@
+// thelet.shevach@gmail.com
+#pragma once
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace coup_sim {
+
+/* TimingWheel – hierarchical timer wheel (4 levels × 256 slots, 2^32 ticks
+   ahead before a timer is parked and re-cascaded).  Timers live in a pooled
+   node array linked into per-slot lists, so schedule() and cancel() are
+   O(1) and a tick touches one slot plus, every 256 ticks, one cascade.
+   Time is in abstract ticks; the owner decides how long one is.
+   Single-threaded: the owner's thread calls everything, including the
+   onFire callback from inside advance().                                */
+class TimingWheel {
+public:
+    using TimerId = std::uint64_t;                 // node | generation << 32
+    static constexpr TimerId  none     = 0;
+    static constexpr unsigned kLevels  = 4;
+    static constexpr unsigned kBits    = 8;
+    static constexpr unsigned kSlots   = 1u << kBits;
+
+    explicit TimingWheel(std::function<void(std::uint64_t payload)> onFire);
+
+    /* fires onFire(payload) after `delay` ticks (at least one) */
+    TimerId       schedule(std::uint64_t delay, std::uint64_t payload);
+    bool          cancel  (TimerId id);            // false if already fired / cancelled
+    std::size_t   advance (std::uint64_t ticks);   // → timers fired
+    std::uint64_t now()  const { return now_; }
+    std::size_t   size() const { return armed_; }
+
+private:
+    static constexpr std::uint32_t kNil = 0xFFFFFFFFu;
+    struct Node {
+        std::uint64_t expires{0}, payload{0};
+        std::uint32_t prev{kNil}, next{kNil};
+        std::uint32_t gen{1};
+        std::uint32_t slot{kNil};                  // index into heads_, kNil when free
+    };
+
+    void place (std::uint32_t n);                  // into the slot its expiry maps to
+    void detach(std::uint32_t n);
+    std::size_t tick();                            // → timers fired
+
+    std::function<void(std::uint64_t)>      onFire_;
+    std::vector<Node>                       nodes_;
+    std::vector<std::uint32_t>              free_;
+    std::array<std::uint32_t, kLevels*kSlots> heads_;
+    std::uint64_t                           now_{0};
+    std::size_t                             armed_{0};
+};
+
+} // namespace coup_sim
@@ -0,0 +1,52 @@
+// thelet.shevach@gmail.com
+#include "core/Delta.hpp"
+
+using namespace coup;
+
+/* ── LEB128 helpers ────────────────────────────────────────── */
+static void putVar(std::vector<std::uint8_t>& out, std::uint32_t v) {
+    while(v >= 0x80) { out.push_back(static_cast<std::uint8_t>(v | 0x80)); v >>= 7; }
+    out.push_back(static_cast<std::uint8_t>(v));
+}
+
+static std::uint32_t getVar(const std::uint8_t*& p) {
+    std::uint32_t v = 0;
+    for(int shift = 0;; shift += 7) {
+        std::uint8_t b = *p++;
+        v |= std::uint32_t(b & 0x7F) << shift;
+        if(!(b & 0x80)) return v;
+    }
+}
+
+/* ── encode / decode ───────────────────────────────────────── */
+std::size_t coup::encode(const Delta& d, std::vector<std::uint8_t>& out) {
+    const std::size_t start = out.size();
+    const std::uint16_t seats[5] = { d.died, d.revived, d.turn, d.sanctionOn, d.sanctionOff };
+
+    std::uint8_t head = d.nCoins & 0x07;
+    for(int i=0;i<5;++i)
+        if(seats[i] != Delta::none) head |= std::uint8_t(1u << (3+i));
+    out.push_back(head);
+
+    for(std::uint8_t i=0;i<d.nCoins;++i) {
+        putVar(out, d.coins[i].seat);
+        putVar(out, d.coins[i].value);
+    }
+    for(auto s : seats)
+        if(s != Delta::none) putVar(out, s);
+    return out.size() - start;
+}
+
+Delta coup::decode(const std::uint8_t*& p) {
+    Delta d;
+    const std::uint8_t head = *p++;
+    d.nCoins = head & 0x07;
+    for(std::uint8_t i=0;i<d.nCoins;++i) {
+        d.coins[i].seat  = static_cast<std::uint16_t>(getVar(p));
+        d.coins[i].value = getVar(p);
+    }
+    std::uint16_t* seats[5] = { &d.died, &d.revived, &d.turn, &d.sanctionOn, &d.sanctionOff };
+    for(int i=0;i<5;++i)
+        if(head & (1u << (3+i))) *seats[i] = static_cast<std::uint16_t>(getVar(p));
+    return d;
+}
@@ -6,24 +6,38 @@
 using namespace coup;
 
 /* ── join / lookup ─────────────────────────────────────────── */
-void Game::registerPlayer(Player* p) {
+void Game::registerPlayer(Player* p, const std::string& name) {
+    const std::size_t seat = roster_.size();
+    p->seat_ = seat;
     roster_.push_back(p);
+    nameIds_.push_back(names_.intern(name));
     alive_.push_back(true);
+    coins_.push_back(0);
+    lastArrested_.push_back(static_cast<std::size_t>(-1));
+    sanctionedUntil_.push_back(0);
+    ++aliveCount_;
+    next_.push_back(seat);
+    prev_.push_back(seat);
+    if(seat == 0) return;
+    if(!alive_[0]) { rebuildRing(); return; }  // joined a game in progress
+    const std::size_t last = prev_[0];         // append: last → seat → 0
+    next_[last] = seat;  prev_[seat] = last;
+    next_[seat] = 0;     prev_[0]    = seat;
 }
 
 Player& Game::playerAt(std::size_t i)              { return *roster_.at(i); }
 const Player& Game::playerAt(std::size_t i) const  { return *roster_.at(i); }
 
 std::size_t Game::indexOf(const Player& p) const {
-    auto it = std::find(roster_.begin(), roster_.end(), &p);
-    if(it == roster_.end()) throw NoSuchPlayer("player not in roster");
-    return std::distance(roster_.begin(), it);
+    if(p.seat_ >= roster_.size() || roster_[p.seat_] != &p) throw NoSuchPlayer("player not in roster");
+    return p.seat_;
 }
 
 /* ── turn rotation ─────────────────────────────────────────── */
 void Game::nextTurn() {
-    do { turnIdx_ = (turnIdx_ + 1) % roster_.size(); } while(!alive_[turnIdx_]);
+    turnIdx_ = next_[turnIdx_];      // stale links of a dead holder still lead on
     ++tick_;
+    touch(turnIdx_);                 // onNewTurn may pay / clear sanction
 
     /* when the *actor* of lastBlockable_ gets the turn again → expire */
     if(lastBlockable_ && lastBlockable_->expiresOnTurnIdx == turnIdx_)
@@ -32,9 +46,53 @@ void Game::nextTurn() {
     roster_[turnIdx_]->onNewTurn();
 }
 
+/* ── living-seat ring ───────────────────────────────────────── */
+void Game::unlink(std::size_t seat) {
+    next_[prev_[seat]] = next_[seat];
+    prev_[next_[seat]] = prev_[seat];
+    if(seat == head_) head_ = next_[seat];     // ring is ascending from head_
+}
+
+void Game::relink(std::size_t seat) {
+    const std::size_t p = prev_[seat], n = next_[seat];
+    if(alive_[p] && alive_[n] && next_[p] == n && p != seat) {
+        next_[p] = seat;                 // LIFO: neighbours are as we left them
+        prev_[n] = seat;
+        if(seat < head_) head_ = seat;
+        return;
+    }
+    rebuildRing();                       // out-of-order revival (load() etc.)
+}
+
+void Game::rebuildRing() {
+    const std::size_t n = roster_.size();
+    std::size_t first = n;
+    for(std::size_t i=0;i<n && first==n;++i) if(alive_[i]) first = i;
+    if(first == n) return;               // nobody alive: leave links as they are
+    head_ = first;
+    /* two laps each way, so every seat – dead ones too – ends up pointing
+       at its nearest living neighbours                                  */
+    std::size_t living = first;
+    for(std::size_t k=2*n; k-- > 0; ) {
+        next_[k % n] = living;
+        if(alive_[k % n]) living = k % n;
+    }
+    living = first;
+    for(std::size_t k=0; k<2*n; ++k) {
+        prev_[k % n] = living;
+        if(alive_[k % n]) living = k % n;
+    }
+}
+
 /* ── forced Coup when ≥10 coins ────────────────────────────── */
-void Game::enforce10CoinRule(Player& p) {
-    if(p.coins() >= 10) throw IllegalAction("Holding 10 coins – must coup");
+void Game::enforce10CoinRule(std::size_t seat, Action::Type t) {
+    if(coins_[seat] >= 10 && t != Action::Type::Coup)
+        throw IllegalAction("Holding 10 coins – must coup");
+}
+
+void Game::spend(std::size_t seat, int c) {
+    if(coins_[seat] < c) throw NotEnoughCoins("Not enough coins");
+    coins_[seat] -= c;
 }
 
 /* remember a Tax / Bribe / Coup until actor’s next turn ----- */
@@ -42,82 +100,160 @@ void Game::recordBlockable(const Action& a) {
     lastBlockable_ = Remembered{a, static_cast<std::size_t>(turnIdx_)};
 }
 
+/* ── delta journal ------------------------------------------- */
+void Game::beginDelta() {
+    nTouched_   = 0;
+    turnBefore_ = turnIdx_;
+}
+
+void Game::touch(std::size_t seat) {
+    for(std::size_t i=0;i<nTouched_;++i)
+        if(touched_[i].seat == seat) return;
+    touched_.at(nTouched_++) = Touched{seat, coins_[seat], lastArrested_[seat], sanctionedUntil_[seat], alive_[seat]};
+}
+
+void Game::emitDelta() {
+    if(sinks_.empty() || muted_) return;
+    emitNet(touched_.data(), nTouched_, turnBefore_);
+}
+
+/* diff `seats` (old values) against the table; a single action always fits
+   one Delta, a batch may need a new one when a slot is already taken      */
+void Game::emitNet(const Touched* seats, std::size_t n, std::size_t turnBefore) {
+    Delta d;
+    auto flush = [&] { for(auto& s : sinks_) s.second(d); d = Delta{}; };
+    for(std::size_t i=0;i<n;++i) {
+        const Touched& t  = seats[i];
+        const auto   seat = static_cast<std::uint16_t>(t.seat);
+        const bool coins   = coins_[t.seat] != t.coins;
+        const bool died    =  t.alive && !alive_[t.seat];
+        const bool revived = !t.alive &&  alive_[t.seat];
+        const bool on      = sanctionedUntil_[t.seat] > t.sanctionedUntil;
+        const bool off     = t.sanctionedUntil && !sanctionedUntil_[t.seat];
+        if((coins && d.nCoins == d.coins.size()) || (died && d.died != Delta::none)
+        || (revived && d.revived != Delta::none) || (on && d.sanctionOn != Delta::none)
+        || (off && d.sanctionOff != Delta::none))
+            flush();
+        if(coins)   d.coins[d.nCoins++] = {seat, static_cast<std::uint32_t>(coins_[t.seat])};
+        if(died)    d.died        = seat;
+        if(revived) d.revived     = seat;
+        if(on)      d.sanctionOn  = seat;
+        if(off)     d.sanctionOff = seat;
+    }
+    if(turnIdx_ != turnBefore) d.turn = static_cast<std::uint16_t>(turnIdx_);
+    flush();
+}
+
+std::size_t Game::subscribe(DeltaSink sink) {
+    sinks_.emplace_back(nextSinkId_, std::move(sink));
+    return nextSinkId_++;
+}
+
+void Game::unsubscribe(std::size_t id) {
+    std::erase_if(sinks_, [id](const auto& s){ return s.first == id; });
+}
+
 /* ── perform ------------------------------------------------- */
 void Game::perform(const Action& a) {
+    if(pending_)                                    throw IllegalAction("An action is pending");
     if(!alive_.at(a.actor))                         throw IllegalAction("Eliminated");
     if(a.actor != turnIdx_ && a.type != Action::Type::Block)
                                                     throw NotYourTurn("Wait for your turn");
 
-    Player& actor = playerAt(a.actor);
-    enforce10CoinRule(actor);
+    if(a.target && (*a.target >= roster_.size() || *a.target == a.actor || !alive_[*a.target]))
+                                                    throw IllegalAction("Target must be another living player");
+
+    const std::size_t me = a.actor;
+    const Player& actor = playerAt(me);
+    enforce10CoinRule(me, a.type);
+
+    beginDelta();
+    touch(a.actor);
+    if(a.target) touch(*a.target);
 
     switch(a.type) {
     case Action::Type::Gather:
         // cannot gather if currently sanctioned
-        if (actor.sanctionedUntilTurn_ >  tick_) {
+        if (sanctionedUntil_[me] >  tick_) {
             throw IllegalAction("Player is sanctioned and cannot gather");
         }
-        actor.addCoins(1);
+        coins_[me] += 1;
         break;
     
     case Action::Type::Tax:
         // cannot tax if currently sanctioned
-        if (actor.sanctionedUntilTurn_ > tick_) {
+        if (sanctionedUntil_[me] > tick_) {
             throw IllegalAction("Player is sanctioned and cannot tax");
         }
-        actor.addCoins(actor.role() == "Governor" ? 3 : 2);
+        coins_[me] += actor.role() == "Governor" ? 3 : 2;
         recordBlockable(a);
         break;
 
     case Action::Type::Bribe:
-        actor.spendCoins(4);
+        spend(me, 4);
         recordBlockable(a);          // Judge may undo later
+        emitDelta();
         return;                      // extra action, keep same turnIdx_
 
 
+    case Action::Type::Invest:
+        // Baron trades 3 coins for 6
+        if (actor.role() != "Baron") {
+            throw IllegalAction("Only a Baron can invest");
+        }
+        // a sanction also shuts the Baron out of the bank
+        if (sanctionedUntil_[me] > tick_) {
+            throw IllegalAction("Player is sanctioned and cannot invest");
+        }
+        spend(me, 3);
+        coins_[me] += 6;
+        break;
+
     case Action::Type::Arrest: {
         if (!a.target) {
             throw IllegalAction("Need target");
         }
-        Player& tgt   = playerAt(*a.target);
+        const std::size_t tgt = *a.target;
         // cannot arrest the same target twice in a row
-        if (actor.lastArrested_ == *a.target) {
+        if (lastArrested_[me] == tgt) {
             throw IllegalAction("Cannot arrest same target twice");
         }
 
-        const std::string &role = tgt.role();
+        const std::string role = playerAt(tgt).role();
         if (role == "Merchant") {
             // Merchant loses 2 coins; arresting player gets no coin.
-            tgt.spendCoins(2);
+            spend(tgt, 2);
         }
         else if (role == "General") {
             // General loses nothing; arresting player still earns 1 coin.
-            actor.addCoins(1);
+            coins_[me] += 1;
         }
         else {
             // All others lose 1, and arresting player gains 1.
-            tgt.spendCoins(1);
-            actor.addCoins(1);
+            spend(tgt, 1);
+            coins_[me] += 1;
         }
 
-        actor.lastArrested_ = *a.target;
+        lastArrested_[me] = tgt;
         break;
     }
 
 
     case Action::Type::Sanction:{
         if(!a.target)                       throw IllegalAction("Need target");
-        Player& tgt = playerAt(*a.target);
-        actor.spendCoins(3);
-        tgt.sanctionedUntilTurn_ = tick_ + roster_.size();
-        if(tgt.role()=="Baron")  tgt.addCoins(1);
-        if(tgt.role()=="Judge")  actor.spendCoins(1);
+        const std::size_t tgt  = *a.target;
+        const std::string role = playerAt(tgt).role();
+        spend(me, role=="Judge" ? 4 : 3);   // Judge: +1 penalty
+        sanctionedUntil_[tgt] = tick_ + roster_.size();
+        if(role=="Baron")  coins_[tgt] += 1;
         break;}
 
     case Action::Type::Coup:{
         if(!a.target)                       throw IllegalAction("Need target");
-        actor.spendCoins(7);
+        spend(me, 7);
         alive_.at(*a.target) = false;       // out of the game
+        --aliveCount_;
+        unlink(*a.target);
         recordBlockable(a);                 // General may block
         break;}
 
@@ -127,6 +263,7 @@ void Game::perform(const Action& a) {
 
     pending_.reset();
     nextTurn();
+    emitDelta();
 }
 
 /* ── block / undo ------------------------------------------- */
@@ -136,33 +273,45 @@ void Game::block(const Action& b) {
         return src.actor != b.actor; // can’t block yourself
     };
 
-    const Action* targetAct = nullptr;
+    if(pending_) { blockPending(b); return; }
 
-    if(pending_ && matches(*pending_))          targetAct = &*pending_;
-    else if(lastBlockable_ && matches(lastBlockable_->act))
+    const Action* targetAct = nullptr;
+    if(lastBlockable_ && matches(lastBlockable_->act))
                                               targetAct = &lastBlockable_->act;
 
     if(!targetAct) throw IllegalAction("Nothing to block");
+    /* the one way back in: a General blocking the coup that removed them */
+    const bool ownCoup = targetAct->type==Action::Type::Coup && targetAct->target==b.actor;
+    if(!alive_.at(b.actor) && !ownCoup) throw IllegalAction("Eliminated");
 
-    Player& blocker = playerAt(b.actor);
-    Player& actor   = playerAt(targetAct->actor);
+    const Player& blocker = playerAt(b.actor);
+    const Player& actor   = playerAt(targetAct->actor);
+
+    beginDelta();
+    touch(b.actor);
+    touch(targetAct->actor);
+    if(targetAct->target) touch(*targetAct->target);
 
     switch(targetAct->type)
     {
     case Action::Type::Tax:
         if(blocker.role()!="Governor") throw IllegalAction("Only Governor");
-        actor.spendCoins(actor.role()=="Governor"?3:2);
+        spend(targetAct->actor, actor.role()=="Governor"?3:2);
         break;
 
     case Action::Type::Bribe:
         if(blocker.role()!="Judge")    throw IllegalAction("Only Judge");
-        actor.addCoins(4);
+        coins_[targetAct->actor] += 4;
         break;
 
     case Action::Type::Coup:
         if(blocker.role()!="General")  throw IllegalAction("Only General");
-        blocker.spendCoins(5);
-        alive_.at(targetAct->target.value()) = true; // revive victim
+        spend(b.actor, 5);
+        if(!alive_.at(targetAct->target.value())) {  // revive victim
+            alive_[*targetAct->target] = true;
+            ++aliveCount_;
+            relink(*targetAct->target);
+        }
         break;
 
     default: throw IllegalAction("Cannot block this action");
@@ -170,39 +319,235 @@ void Game::block(const Action& b) {
 
     pending_.reset();
     lastBlockable_.reset();
+    emitDelta();
+}
+
+/* ── propose / commit ----------------------------------------- */
+void Game::propose(const Action& a) {
+    if(pending_)                                    throw IllegalAction("An action is pending");
+    if(!alive_.at(a.actor))                         throw IllegalAction("Eliminated");
+    if(a.actor != turnIdx_)                         throw NotYourTurn("Wait for your turn");
+    if(a.target && (*a.target >= roster_.size() || *a.target == a.actor || !alive_[*a.target]))
+                                                    throw IllegalAction("Target must be another living player");
+
+    enforce10CoinRule(a.actor, a.type);
+
+    /* the same checks perform() makes, without touching anything */
+    switch(a.type) {
+    case Action::Type::Tax:
+        if(sanctionedUntil_[a.actor] > tick_)  throw IllegalAction("Player is sanctioned and cannot tax");
+        break;
+    case Action::Type::Bribe:
+        if(coins_[a.actor] < 4)                throw NotEnoughCoins("Not enough coins");
+        break;
+    case Action::Type::Coup:
+        if(!a.target)                          throw IllegalAction("Need target");
+        if(coins_[a.actor] < 7)                throw NotEnoughCoins("Not enough coins");
+        break;
+    default:
+        throw IllegalAction("Only Tax, Bribe and Coup are proposed");
+    }
+    pending_ = a;
+}
+
+void Game::commit() {
+    if(!pending_) throw IllegalAction("Nothing to commit");
+    const Action a = *pending_;
+    pending_.reset();
+    perform(a);                              // rejected (e.g. coins taken meanwhile):
+                                             // dropped, the actor still holds the turn
+    if(lastBlockable_ && lastBlockable_->act == a)
+        lastBlockable_.reset();              // its window is already over
+}
+
+/* a blocked proposal is dropped, never applied and reverted; it costs
+   what the immediate path nets out to – a blocked Coup still takes the
+   couper's 7, the General pays 5                                      */
+void Game::blockPending(const Action& b) {
+    const Action& a = *pending_;
+    if(a.actor == b.actor)  throw IllegalAction("Nothing to block");
+    if(!alive_.at(b.actor)) throw IllegalAction("Eliminated");
+
+    const Player& blocker = playerAt(b.actor);
+    switch(a.type) {
+    case Action::Type::Tax:
+        if(blocker.role()!="Governor") throw IllegalAction("Only Governor");
+        break;
+    case Action::Type::Bribe:
+        if(blocker.role()!="Judge")    throw IllegalAction("Only Judge");
+        break;
+    case Action::Type::Coup:
+        if(blocker.role()!="General")  throw IllegalAction("Only General");
+        if(coins_[b.actor] < 5)        throw NotEnoughCoins("Not enough coins");
+        if(coins_[a.actor] < 7)        throw NotEnoughCoins("Not enough coins");   // drained meanwhile
+        break;
+    default: throw IllegalAction("Cannot block this action");
+    }
+
+    beginDelta();
+    touch(b.actor);
+    if(a.type == Action::Type::Coup) {
+        touch(a.actor);
+        spend(a.actor, 7);
+        spend(b.actor, 5);
+    }
+    const bool endsTurn = a.type != Action::Type::Bribe;   // Bribe never took the turn
+    pending_.reset();
+    if(endsTurn) nextTurn();
+    emitDelta();
 }
 
 /* ── role helpers ------------------------------------------- */
 void Game::governorUndoTax(Player& gov, Player& taxed){
     if(gov.role()!="Governor") throw IllegalAction("Not a governor");
-    taxed.spendCoins(taxed.role()=="Governor"?3:2);
+    beginDelta();
+    const std::size_t seat = indexOf(taxed);
+    touch(seat);
+    spend(seat, taxed.role()=="Governor"?3:2);
+    emitDelta();
 }
-void Game::baronInvest(Player& baron){
-    baron.spendCoins(3);
-    baron.addCoins(5);
+int Game::spyPeek(Player& spy, Player& tgt){
+    const std::size_t target = indexOf(tgt);
+    const Peek seen{indexOf(spy), target, tick_, coins_[target]};
+    for(auto& p : peeks_)
+        if(p.spy==seen.spy && p.target==seen.target){ p = seen; return seen.coins; }
+    peeks_.push_back(seen);
+    return seen.coins;
+}
+
+const Game::Peek* Game::lastPeek(std::size_t spy, std::size_t target) const {
+    for(const auto& p : peeks_)
+        if(p.spy==spy && p.target==target) return &p;
+    return nullptr;
 }
-void Game::spyPeek(Player&, Player&){/* nothing */}
 void Game::spyBlockArrest(Player& spy, Player& tgt){
-    tgt.lastArrested_ = indexOf(spy);
+    lastArrested_[indexOf(tgt)] = indexOf(spy);
+}
+
+/* ── plain-value state ---------------------------------------- */
+Game::State Game::state() const {
+    State s;
+    s.seats.reserve(roster_.size());
+    for(std::size_t i=0;i<roster_.size();++i)
+        s.seats.push_back({coins_[i], lastArrested_[i], sanctionedUntil_[i], alive_[i]});
+    s.turn = turnIdx_;
+    s.tick = tick_;
+    if(lastBlockable_){
+        s.blockable        = lastBlockable_->act;
+        s.blockableExpires = lastBlockable_->expiresOnTurnIdx;
+    }
+    s.pending = pending_;
+    return s;
+}
+
+void Game::load(const State& s) {
+    const std::size_t n = roster_.size();
+    if(s.seats.size() != n) throw IllegalAction("State does not fit this table");
+    /* checked before anything is overwritten: a bad state leaves the table as it was */
+    if(s.turn >= n || !s.seats[s.turn].alive) throw IllegalAction("State: turn holder is not a living seat");
+    auto openAction = [&](const std::optional<Action>& a) {
+        if(!a) return true;
+        const bool coup = a->type == Action::Type::Coup;
+        return (coup || a->type == Action::Type::Tax || a->type == Action::Type::Bribe)
+            && a->actor < n
+            && (coup ? a->target && *a->target < n : !a->target);
+    };
+    if(!openAction(s.blockable) || !openAction(s.pending)) throw IllegalAction("State: malformed open action");
+    for(std::size_t i=0;i<n;++i){
+        coins_[i]           = s.seats[i].coins;
+        lastArrested_[i]    = s.seats[i].lastArrested;
+        sanctionedUntil_[i] = s.seats[i].sanctionedUntil;
+        alive_[i]           = s.seats[i].alive;
+    }
+    aliveCount_ = static_cast<std::size_t>(std::count(alive_.begin(), alive_.end(), true));
+    rebuildRing();
+    turnIdx_ = s.turn;
+    tick_    = s.tick;
+    pending_ = s.pending;
+    if(s.blockable) lastBlockable_ = Remembered{*s.blockable, s.blockableExpires};
+    else            lastBlockable_.reset();
+}
+
+/* ── make / unmake ------------------------------------------- */
+/* the delta journal already holds every seat an action can change
+   (actor, target, next turn holder / blocker, victim) as it was before */
+Game::UndoRecord Game::make(const Action& a) {
+    UndoRecord u;
+    u.turn_      = turnIdx_;
+    u.tick_      = tick_;
+    u.blockable_ = lastBlockable_;
+    u.pending_   = pending_;
+    muted_ = true;
+    try {
+        if(a.type == Action::Type::Block) block(a);
+        else                              perform(a);
+    } catch(...) {
+        muted_ = false;
+        throw;
+    }
+    muted_    = false;
+    u.seats_  = touched_;
+    u.nSeats_ = nTouched_;
+    return u;
+}
+
+void Game::unmake(const UndoRecord& u) {
+    for(std::size_t i=u.nSeats_; i-- > 0; ) {
+        const Touched& t = u.seats_[i];
+        coins_[t.seat]           = t.coins;
+        lastArrested_[t.seat]    = t.lastArrested;
+        sanctionedUntil_[t.seat] = t.sanctionedUntil;
+        if(t.alive == alive_[t.seat]) continue;
+        alive_[t.seat] = t.alive;
+        if(t.alive) { ++aliveCount_; relink(t.seat); }   // coup undone
+        else        { --aliveCount_; unlink(t.seat); }   // revival undone
+    }
+    turnIdx_       = u.turn_;
+    tick_          = u.tick_;
+    lastBlockable_ = u.blockable_;
+    pending_       = u.pending_;
+}
+
+/* ── batches ------------------------------------------------- */
+/* validated by playing it: make() each action, unmake() them all on the
+   first rejection – cheaper than rehearsing on a copy of the table      */
+void Game::performBatch(std::span<const Action> batch) {
+    if(batch.empty()) return;
+    const std::size_t turnBefore = turnIdx_;
+    batchUndo_.clear();
+    try {
+        for(const Action& a : batch) batchUndo_.push_back(make(a));
+    } catch(...) {
+        while(!batchUndo_.empty()) { unmake(batchUndo_.back()); batchUndo_.pop_back(); }
+        throw;
+    }
+    if(sinks_.empty()) return;
+
+    /* each seat's value from before its first touch */
+    batchSeats_.clear();
+    for(const UndoRecord& u : batchUndo_)
+        for(std::size_t i=0;i<u.nSeats_;++i)
+            if(std::none_of(batchSeats_.begin(), batchSeats_.end(),
+                            [&](const Touched& t){ return t.seat == u.seats_[i].seat; }))
+                batchSeats_.push_back(u.seats_[i]);
+    emitNet(batchSeats_.data(), batchSeats_.size(), turnBefore);
 }
 
 /* ── living players & winner -------------------------------- */
 std::vector<std::string> Game::players() const {
     std::vector<std::string> out;
-    for(std::size_t i=0;i<roster_.size();++i)
-        if(alive_[i]) out.push_back(roster_[i]->name());
+    out.reserve(aliveCount_);
+    const auto view = living();
+    for(auto it=view.begin(); it!=view.end(); ++it) out.push_back(nameOf(it.seat()));
     return out;
 }
 
-const std::string& Game::turn() const { return roster_.at(turnIdx_)->name(); }
+const std::string& Game::turn() const { return nameOf(turnIdx_); }
 
-std::string Game::winner() const {
-    std::string name;
-    for(std::size_t i=0;i<roster_.size();++i)
-        if(alive_[i]){
-            if(!name.empty()) throw GameNotFinished("Game still active");
-            name = roster_[i]->name();
-        }
-    if(name.empty()) throw NoSuchPlayer("No players!");
-    return name;
+std::size_t Game::winnerIndex() const {
+    if(aliveCount_ > 1)  throw GameNotFinished("Game still active");
+    if(aliveCount_ == 0) throw NoSuchPlayer("No players!");
+    return head_;                        // the only living seat
 }
+
+std::string Game::winner() const { return nameOf(winnerIndex()); }
@@ -0,0 +1,17 @@
+// thelet.shevach@gmail.com
+#include "core/NameTable.hpp"
+
+using namespace coup;
+
+NameTable::Id NameTable::intern(const std::string& name) {
+    if(auto it = ids_.find(name); it != ids_.end()) return it->second;
+    const auto id = static_cast<Id>(names_.size());
+    names_.push_back(name);
+    ids_.emplace(names_.back(), id);
+    return id;
+}
+
+NameTable::Id NameTable::find(const std::string& name) const {
+    auto it = ids_.find(name);
+    return it == ids_.end() ? none : it->second;
+}
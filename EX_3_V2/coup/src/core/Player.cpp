@@ -6,23 +6,24 @@ using namespace coup;
 
 /*──────── ctor ───────*/
 Player::Player(Game& g, const std::string& n)
-        : game_{g}, name_{n}
+        : game_{g}
 {
-    game_.registerPlayer(this);
+    game_.registerPlayer(this, n);
 }
 
 /*──────── bookkeeping helpers ───*/
-void Player::spendCoins(int c) {
-    if(coins_ < c) throw NotEnoughCoins("Not enough coins");
-    coins_ -= c;
-}
+const std::string& Player::name() const { return game_.nameOf(seat_); }
+int  Player::coins() const      { return game_.coins_[seat_]; }
+void Player::addCoins(int c)    { game_.coins_[seat_] += c; }
+void Player::spendCoins(int c)  { game_.spend(seat_, c); }
 
 void Player::onNewTurn() {
     /* Merchant passive bonus */
-    if(role()=="Merchant" && coins_>=3) coins_ += 1;
+    int& coins = game_.coins_[seat_];
+    if(role()=="Merchant" && coins>=3) coins += 1;
     /* clear sanction flag if its time passed */
-    if(sanctionedUntilTurn_ && game_.turn() == name_)
-        sanctionedUntilTurn_ = 0;
+    if(game_.sanctionedUntil_[seat_] && game_.turnIndex() == seat_)
+        game_.sanctionedUntil_[seat_] = 0;
 }
 
 /*──────── generic action wrappers ─────*/
@@ -52,13 +53,15 @@ void Judge::undo(Player& briber) {
     game_.block( make(game_.indexOf(*this), Action::Type::Block) );
 }
 
+/* Spy – look at someone's coins; the Game remembers what was seen  */
+int Spy::peek(Player& tgt)          { return game_.spyPeek(*this,tgt); }
+
 /* Spy – stop someone from being arrested next turn                   */
 void Spy::blockArrest(Player& tgt)  { game_.spyBlockArrest(*this,tgt); }
 
-/* Baron – invest finishes the turn                                  */
+/* Baron – invest 3 coins, get 6 back; finishes the turn             */
 void Baron::invest() {
-    game_.baronInvest(*this);
-    game_.perform( make(game_.indexOf(*this), Action::Type::Gather) ); // dummy to advance turn
+    game_.perform( make(game_.indexOf(*this), Action::Type::Invest) );
 }
 
 /* General – pay 5 coins to save a Coup victim                       */
@@ -2,26 +2,70 @@
 #include "gui/BoardWidget.hpp"
 #include "gui/SFMLWindow.hpp"     // need the full type for implementation
 #include "gui/CardWidget.hpp"
-#include <array>
+#include <algorithm>
+#include <cmath>
 
 using namespace coup_gui;
 
-BoardWidget::BoardWidget(const sf::Font& f)
+BoardWidget::BoardWidget(const sf::Font& f, std::size_t seats, sf::Vector2f viewport)
+    : seats_(std::max(seats, kClassicSeats))
+    , cols_(std::max<std::size_t>(1, static_cast<std::size_t>((viewport.x - kMargin) / kPitchX)))
+    , rows_((seats_ + cols_ - 1) / cols_)
+    , viewH_(viewport.y)
 {
-    const std::array<sf::Vector2f,6> pos = {
-        sf::Vector2f{10,10},  {240,10},  {470,10},
-        sf::Vector2f{10,330}, {240,330}, {470,330}
-    };
-    for (auto p : pos)
-        cards_.push_back(std::make_unique<CardWidget>(f, p));
+    const auto visibleRows = static_cast<std::size_t>(std::ceil(viewH_ / kPitchY)) + 1;
+    const std::size_t pool = std::min(seats_, visibleRows * cols_);
+    for (std::size_t i = 0; i < pool; ++i)
+        cards_.push_back(std::make_unique<CardWidget>(f, sf::Vector2f{kMargin, kMargin}));
+    layout();
+}
+
+std::size_t BoardWidget::endVisible() const
+{
+    return std::min(seats_, firstVisible() + cards_.size());
+}
+
+CardWidget* BoardWidget::card(std::size_t seat)
+{
+    if (seat < firstVisible() || seat >= endVisible()) return nullptr;
+    return cards_[seat - firstVisible()].get();
+}
+
+/* pool slot k shows seat firstVisible()+k, shifted by the sub-row scroll */
+void BoardWidget::layout()
+{
+    for (std::size_t k = 0; k < cards_.size(); ++k) {
+        const std::size_t row = firstRow_ + k / cols_, col = k % cols_;
+        cards_[k]->place({kMargin + col * kPitchX, kMargin + row * kPitchY - scroll_});
+    }
+}
+
+bool BoardWidget::scroll(float dy)
+{
+    const float maxScroll = std::max(0.f, rows_ * kPitchY + kMargin - viewH_);
+    scroll_ = std::clamp(scroll_ + dy, 0.f, maxScroll);
+    const std::size_t first = std::min(static_cast<std::size_t>(scroll_ / kPitchY),
+                                       rows_ - std::min(rows_, cards_.size() / cols_));
+    const bool rebound = first != firstRow_;
+    firstRow_ = first;
+    layout();
+    return rebound;
+}
+
+bool BoardWidget::scrollTo(std::size_t seat)
+{
+    const float top = (seat / cols_) * kPitchY;
+    if (top >= scroll_ && top + kPitchY <= scroll_ + viewH_) return false;
+    return scroll(top - scroll_);
 }
 
 void BoardWidget::draw(sf::RenderTarget& rt)
 {
-    for (auto& c : cards_) c->draw(rt);
+    for (std::size_t s = firstVisible(); s < endVisible(); ++s)
+        cards_[s - firstVisible()]->draw(rt);
 }
 void BoardWidget::handleClick(const sf::Event::MouseButtonEvent& ev,SFMLWindow& gui)
 {
-for (auto& c : cards_) c->handleClick(ev, gui);
+for (std::size_t s = firstVisible(); s < endVisible(); ++s)
+    cards_[s - firstVisible()]->handleClick(ev, gui);
 }
-
@@ -5,7 +5,8 @@ using namespace coup_gui;
 
 
 CardWidget::CardWidget(const sf::Font& f, sf::Vector2f pos)
-: panel_  ()
+: pos_    (pos)
+, panel_  ()
 , title_  ()
 , coins_  ()
 , buttons_{
@@ -36,6 +37,17 @@ CardWidget::CardWidget(const sf::Font& f, sf::Vector2f pos)
     coins_.setPosition(pos.x + 8, pos.y + 28);
   }
 
+void CardWidget::place(sf::Vector2f pos)
+{
+    const float dx = pos.x - pos_.x, dy = pos.y - pos_.y;
+    if (dx == 0 && dy == 0) return;
+    panel_.move(dx, dy);
+    title_.move(dx, dy);
+    coins_.move(dx, dy);
+    for (auto& b : buttons_) b.move(dx, dy);
+    pos_ = pos;
+}
+
 void CardWidget::draw(sf::RenderTarget& rt)
 {
     rt.draw(panel_);
@@ -46,6 +58,6 @@ void CardWidget::draw(sf::RenderTarget& rt)
 void CardWidget::handleClick(const sf::Event::MouseButtonEvent& ev,SFMLWindow& gui)
 {
 for (auto& b : buttons_)
-if (b.contains(ev)) b.onClick();
+if (b.contains(ev) && b.onClick) b.onClick();
 }
 
@@ -5,41 +5,85 @@
 
 #include <sstream>
 using coup_gui::SFMLWindow;
+using coup_gui::CardWidget;
 using coup::Player;
 
 SFMLWindow::SFMLWindow(coup::Game& g) : game_(g)
 {
     font_.loadFromFile("/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf");
-    board_ = std::make_unique<BoardWidget>(font_);
+    board_ = std::make_unique<BoardWidget>(font_, game_.roster().size());
+    sinkId_ = game_.subscribe([this](const coup::Delta& d){ applyDelta(d); });
 }
 
+SFMLWindow::~SFMLWindow() { game_.unsubscribe(sinkId_); }
+
 /*──────── convenience ───────*/
 void SFMLWindow::postMessage(const std::string& txt){ message_=txt; }
 
 bool SFMLWindow::isSanctioned(const Player& p) const
 {
-     return p.sanctionedUntilTurn_ > game_.tick();  
+     return game_.sanctioned(p.seat());
 }
 
 /*──────── panel refresh ───────*/
+void SFMLWindow::paintCard(std::size_t i){
+    CardWidget* cp = board_->card(i);
+    if(!cp) return;                              // scrolled away – painted on return
+    auto& card = *cp;
+    const auto& roster = game_.roster();
+    if(i>=roster.size() || !game_.alive(i)){
+        card.setColor(sf::Color(30,30,30));
+        return;
+    }
+    const Player& pl = *roster[i];
+    auto  base = sf::Color(90,90,90);
+    if(i==game_.turnIndex()) base = sf::Color(200,50,200);
+    if(isSanctioned(pl))     base = sf::Color(50,50,50);
+    card.setColor(base);
+    card.setTitle(pl.name()+" – "+pl.role());
+    card.setCoins(pl.coins());
+}
+
 void SFMLWindow::updatePanels(){
-    const auto& roster = game_.roster(); 
-    for(std::size_t i=0;i<6;++i){
-        auto& card = board_->card(i);
-        if(i>=roster.size() || !game_.alive(i)){
-            card.setColor(sf::Color(30,30,30));
-            continue;
-        }
-        const Player& pl = *roster[i];
-        auto  base = sf::Color(90,90,90);
-        if(i==game_.turnIndex()) base = sf::Color(200,50,200);
-        if(isSanctioned(pl))     base = sf::Color(50,50,50);
-        card.setColor(base);
-        card.setTitle(pl.name()+" – "+pl.role());
-        card.setCoins(pl.coins());
+    if(board_->seats() < game_.roster().size())          // players joined after us
+        board_ = std::make_unique<BoardWidget>(font_, game_.roster().size());
+    for(std::size_t i=board_->firstVisible();i<board_->endVisible();++i) paintCard(i);
+    shownTurn_ = game_.turnIndex();
+    needsFull_ = false;
+}
+
+void SFMLWindow::applyDelta(const coup::Delta& d){
+    if(needsFull_) return;                       // first frame repaints all
+    constexpr auto none = coup::Delta::none;
+    for(std::uint8_t i=0;i<d.nCoins;++i)
+        if(auto* card = board_->card(d.coins[i].seat))
+            card->setCoins(static_cast<int>(d.coins[i].value));
+    for(auto seat : {d.died, d.revived, d.sanctionOn, d.sanctionOff})
+        if(seat!=none) paintCard(seat);
+    if(d.turn!=none){
+        paintCard(shownTurn_);
+        shownTurn_ = d.turn;
+        if(board_->scrollTo(d.turn))                 // follow the turn on big tables
+            for(std::size_t i=board_->firstVisible();i<board_->endVisible();++i) paintCard(i);
+        else paintCard(d.turn);
     }
 }
 
+/*──────── one frame ───────*/
+void SFMLWindow::scroll(float dy){
+    if(board_->scroll(dy))
+        for(std::size_t i=board_->firstVisible();i<board_->endVisible();++i) paintCard(i);
+}
+
+void SFMLWindow::renderFrame(sf::RenderTarget& rt)
+{
+    if(needsFull_ || board_->seats() < game_.roster().size()) updatePanels();
+    rt.clear(sf::Color::Black);
+    board_->draw(rt);
+    sf::Text bar(message_, font_, 16); bar.setPosition(10,750);
+    rt.draw(bar);
+}
+
 /*──────── main loop ───────*/
 int SFMLWindow::run(sf::RenderWindow& win)
 {
@@ -50,12 +94,14 @@ int SFMLWindow::run(sf::RenderWindow& win)
             if(ev.type==sf::Event::MouseButtonPressed){
                 board_->handleClick(ev.mouseButton, *this);
             }
+            if(ev.type==sf::Event::MouseWheelScrolled)
+                scroll(-ev.mouseWheelScroll.delta * 60.f);
+            if(ev.type==sf::Event::KeyPressed){
+                if(ev.key.code==sf::Keyboard::PageDown) scroll( BoardWidget::kPitchY);
+                if(ev.key.code==sf::Keyboard::PageUp)   scroll(-BoardWidget::kPitchY);
+            }
         }
-        updatePanels();
-        win.clear(sf::Color::Black);
-        board_->draw(win);
-        sf::Text bar(message_, font_, 16); bar.setPosition(10,750);
-        win.draw(bar);
+        renderFrame(win);
         win.display();
     }
     return 0;
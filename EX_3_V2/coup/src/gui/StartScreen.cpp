@@ -1,19 +1,25 @@
 // src/gui/StartScreen.cpp
 #include "gui/StartScreen.hpp"
+#include <algorithm>
 #include <array>
 using namespace coup_gui;
 
-StartScreen::StartScreen(sf::RenderWindow& w) : win_(w)
+static const std::array<const char*,6> kRoles={"Governor","Spy","Baron","General","Judge","Merchant"};
+
+StartScreen::StartScreen(sf::RenderWindow& w)
+    : win_(w), names_(kMaxPlayers), roles_(kMaxPlayers, kRoles[0])
 {
     font_.loadFromFile("/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf");
     const float lx=120, rx=450, y0=140, dy=70;
-    for(int i=0;i<6;++i){
+    for(int i=0;i<kRows;++i){
         nameBoxes_.push_back({sf::RectangleShape({220,40}), sf::Text("",font_,18)});
-        roleBoxes_.push_back({sf::RectangleShape({220,40}), sf::Text("Governor",font_,18)});
+        roleBoxes_.push_back({sf::RectangleShape({220,40}), sf::Text("",font_,18)});
+        seatLabels_.emplace_back("", font_, 18);
         nameBoxes_[i].box.setPosition(lx, y0+i*dy);
         roleBoxes_[i].box.setPosition(rx, y0+i*dy);
-        nameBoxes_[i].box.setFillColor(sf::Color(40,40,40));
-        roleBoxes_[i].box.setFillColor(sf::Color(40,40,40));
+        nameBoxes_[i].text.setPosition(lx+8, y0+i*dy+8);
+        roleBoxes_[i].text.setPosition(rx+8, y0+i*dy+8);
+        seatLabels_[i].setPosition(lx-70, y0+i*dy+8);
         nameBoxes_[i].box.setOutlineThickness(2);
         roleBoxes_[i].box.setOutlineThickness(2);
     }
@@ -30,62 +36,77 @@ std::vector<PlayerSpec> StartScreen::choose()
         draw();
     }
     std::vector<PlayerSpec> out;
-    static const std::array<const char*,6> roles={"Governor","Spy","Baron","General","Judge","Merchant"};
+    out.reserve(playerCount_);
     for(int i=0;i<playerCount_;++i){
         PlayerSpec p;
-        p.name = nameBoxes_[i].text.getString();
+        p.name = names_[i];
         if(p.name.empty()) p.name = "P"+std::to_string(i+1);
-        p.role = roleBoxes_[i].text.getString();
-        if(std::find(roles.begin(),roles.end(),p.role)==roles.end()) p.role="Governor";
+        p.role = roles_[i];
         out.push_back(std::move(p));
     }
     return out;
 }
 // -----------------------------------------------------------------
+void StartScreen::scrollRows(int d)
+{
+    firstRow_ = std::clamp(firstRow_ + d, 0, std::max(0, playerCount_ - kRows));
+}
+
 void StartScreen::handleEvent(const sf::Event& ev)
 {
     if(ev.type==sf::Event::KeyPressed){
-        if(ev.key.code==sf::Keyboard::Up   && playerCount_<6) ++playerCount_;
-        if(ev.key.code==sf::Keyboard::Down && playerCount_>2) --playerCount_;
+        const int before = playerCount_;
+        if(ev.key.code==sf::Keyboard::Up)       ++playerCount_;
+        if(ev.key.code==sf::Keyboard::Down)     --playerCount_;
+        if(ev.key.code==sf::Keyboard::PageUp)   playerCount_ += 10;
+        if(ev.key.code==sf::Keyboard::PageDown) playerCount_ -= 10;
+        playerCount_ = std::clamp(playerCount_, 2, kMaxPlayers);
+        if(playerCount_ > before) scrollRows(playerCount_);   // show the newest seat
+        else                      scrollRows(0);
+        if(active_ >= playerCount_) active_ = -1;
         if(ev.key.code==sf::Keyboard::Enter) win_.close();
     }
-    if(ev.type==sf::Event::TextEntered){
-        for(auto& e:nameBoxes_)
-            if(e.active && ev.text.unicode>=32 && ev.text.unicode<128){
-                auto s=e.text.getString(); s+=static_cast<char>(ev.text.unicode);
-                e.text.setString(s);
-            }else if(e.active && ev.text.unicode==8 && !e.text.getString().isEmpty()){
-                auto s=e.text.getString(); s.erase(s.getSize()-1); e.text.setString(s);
-            }
+    if(ev.type==sf::Event::MouseWheelScrolled)
+        scrollRows(ev.mouseWheelScroll.delta > 0 ? -1 : 1);
+    if(ev.type==sf::Event::TextEntered && active_>=0){
+        auto& s = names_[active_];
+        if(ev.text.unicode>=32 && ev.text.unicode<128) s += static_cast<char>(ev.text.unicode);
+        else if(ev.text.unicode==8 && !s.empty())      s.pop_back();
     }
     if(ev.type==sf::Event::MouseButtonPressed){
         sf::Vector2f p{static_cast<float>(ev.mouseButton.x),static_cast<float>(ev.mouseButton.y)};
-        for(auto& e:nameBoxes_){
-            e.active=e.box.getGlobalBounds().contains(p);
-            e.box.setOutlineColor(e.active?sf::Color::Yellow:sf::Color::White);
-        }
-        static const std::array<const char*,6> roles={"Governor","Spy","Baron","General","Judge","Merchant"};
-        for(auto& e:roleBoxes_)
-            if(e.box.getGlobalBounds().contains(p)){
-                std::string cur=e.text.getString();
-                std::size_t idx=(std::find(roles.begin(),roles.end(),cur)-roles.begin()+1)%roles.size();
-                e.text.setString(roles[idx]);
+        active_ = -1;
+        for(int r=0;r<kRows && firstRow_+r<playerCount_;++r){
+            const int seat = firstRow_ + r;
+            if(nameBoxes_[r].box.getGlobalBounds().contains(p)) active_ = seat;
+            if(roleBoxes_[r].box.getGlobalBounds().contains(p)){
+                std::size_t idx=(std::find(kRoles.begin(),kRoles.end(),roles_[seat])-kRoles.begin()+1)%kRoles.size();
+                roles_[seat] = kRoles[idx];
             }
+        }
     }
 }
 // -----------------------------------------------------------------
 void StartScreen::draw()
 {
     win_.clear(sf::Color::Black);
-    sf::Text t("Coup – Pick players (UP/DOWN to change count, ENTER to start)",
+    sf::Text t("Coup – Pick players (UP/DOWN ±1, PAGE ±10, wheel scrolls, ENTER starts)",
                font_,20); t.setPosition(60,60); win_.draw(t);
-    for(int i=0;i<6;++i){
-        bool vis=i<playerCount_;
-        auto& nb=nameBoxes_[i]; auto& rb=roleBoxes_[i];
+    sf::Text n(std::to_string(playerCount_)+" players", font_,18); n.setPosition(60,100); win_.draw(n);
+    for(int r=0;r<kRows;++r){
+        const int seat = firstRow_ + r;
+        const bool vis = seat < playerCount_;
+        auto& nb=nameBoxes_[r]; auto& rb=roleBoxes_[r];
         nb.box.setFillColor(vis?sf::Color(60,60,60):sf::Color(20,20,20));
         rb.box.setFillColor(vis?sf::Color(60,60,60):sf::Color(20,20,20));
+        nb.box.setOutlineColor(vis && seat==active_?sf::Color::Yellow:sf::Color::White);
         win_.draw(nb.box); win_.draw(rb.box);
-        if(vis){ win_.draw(nb.text); win_.draw(rb.text); }
+        if(vis){
+            nb.text.setString(names_[seat]);
+            rb.text.setString(roles_[seat]);
+            seatLabels_[r].setString(std::to_string(seat+1));
+            win_.draw(nb.text); win_.draw(rb.text); win_.draw(seatLabels_[r]);
+        }
     }
     win_.display();
 }
@@ -0,0 +1,271 @@
+// thelet.shevach@gmail.com
+#include "sim/Analytics.hpp"
+#include "sim/Archive.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+
+using namespace coup_sim;
+
+/* ── records ──────────────────────────────────────────────── */
+GameRecord coup_sim::makeRecord(std::uint64_t id, const std::vector<Role>& roles,
+                                const std::vector<std::size_t>& botIds, const GameResult& r)
+{
+    GameRecord rec;
+    rec.id      = id;
+    rec.ticks   = static_cast<std::uint32_t>(r.ticks);
+    rec.players = static_cast<std::uint8_t>(roles.size());
+    if(r.winner != GameResult::noWinner) {
+        rec.winnerSeat = static_cast<std::uint8_t>(r.winner);
+        rec.winnerRole = static_cast<std::uint8_t>(roles[r.winner]);
+    }
+    for(std::size_t k=0;k<kBlockKinds;++k)
+        rec.blocks[k] = static_cast<std::uint16_t>(std::min<std::uint32_t>(r.blocks[k], 0xFFFF));
+    for(std::size_t i=0;i<roles.size() && i<kMaxRecordSeats;++i) {
+        rec.seatRoles |= std::uint64_t(roles[i])  << (4*i);
+        rec.seatBots  |= std::uint64_t(botIds[i]) << (4*i);
+    }
+    return rec;
+}
+
+/* ── BalanceStats ─────────────────────────────────────────── */
+void BalanceStats::add(const GameRecord& r) {
+    ++games;
+    for(std::size_t i=0;i<r.players;++i) ++seats[static_cast<std::size_t>(r.role(i))];
+    if(r.winnerSeat == kNoSeat) ++draws;
+    else                        ++wins[r.winnerRole];
+    for(std::size_t k=0;k<kBlockKinds;++k) blocks[k] += r.blocks[k];
+
+    ticksSum += r.ticks;
+    ticksMin  = std::min<std::uint64_t>(ticksMin, r.ticks);
+    ticksMax  = std::max<std::uint64_t>(ticksMax, r.ticks);
+    ++tickHist[std::min(r.ticks / kTickBucket, kTickBuckets - 1)];
+}
+
+void BalanceStats::merge(const BalanceStats& o) {
+    games += o.games;
+    draws += o.draws;
+    for(std::size_t i=0;i<kRoleCount;++i)   { seats[i] += o.seats[i]; wins[i] += o.wins[i]; }
+    for(std::size_t k=0;k<kBlockKinds;++k)  blocks[k]   += o.blocks[k];
+    for(std::size_t b=0;b<kTickBuckets;++b) tickHist[b] += o.tickHist[b];
+    ticksSum += o.ticksSum;
+    ticksMin  = std::min(ticksMin, o.ticksMin);
+    ticksMax  = std::max(ticksMax, o.ticksMax);
+}
+
+double BalanceStats::winRate(Role r) const {
+    const auto i = static_cast<std::size_t>(r);
+    return seats[i] ? double(wins[i]) / double(seats[i]) : 0.0;
+}
+
+std::uint64_t BalanceStats::tickPercentile(double p) const {
+    const auto want = static_cast<std::uint64_t>(p * double(games));
+    std::uint64_t seen = 0;
+    for(std::size_t b=0;b<kTickBuckets;++b) {
+        seen += tickHist[b];
+        if(seen > want) return std::min<std::uint64_t>((b+1) * kTickBucket, ticksMax);
+    }
+    return ticksMax;
+}
+
+void BalanceStats::writeCsv(const std::string& dir) const {
+    std::ofstream roles(dir + "/roles.csv");
+    roles << "role,seats,wins,win_rate\n";
+    for(std::size_t i=0;i<kRoleCount;++i)
+        roles << roleName(static_cast<Role>(i)) << ',' << seats[i] << ','
+              << wins[i] << ',' << winRate(static_cast<Role>(i)) << '\n';
+    roles << "draw,," << draws << ",\n";
+
+    std::ofstream lengths(dir + "/lengths.csv");
+    lengths << "ticks_from,ticks_to,games\n";
+    for(std::size_t b=0;b<kTickBuckets;++b) {
+        if(!tickHist[b]) continue;
+        lengths << b*kTickBucket << ',';
+        if(b+1<kTickBuckets) lengths << (b+1)*kTickBucket;
+        lengths << ',' << tickHist[b] << '\n';
+    }
+
+    std::ofstream bl(dir + "/blocks.csv");
+    bl << "block,count,per_game\n";
+    const char* names[kBlockKinds] = {"undo_tax", "undo_bribe", "block_coup"};
+    for(std::size_t k=0;k<kBlockKinds;++k)
+        bl << names[k] << ',' << blocks[k] << ','
+           << (games ? double(blocks[k]) / double(games) : 0.0) << '\n';
+
+    if(!roles || !lengths || !bl) throw std::runtime_error("cannot write CSV under " + dir);
+}
+
+/* ── RowGroup ─────────────────────────────────────────────── */
+void RowGroup::push(const GameRecord& r) {
+    id.push_back(r.id);          ticks.push_back(r.ticks);
+    players.push_back(r.players);
+    winnerSeat.push_back(r.winnerSeat);
+    winnerRole.push_back(r.winnerRole);
+    blockTax.push_back(r.blocks[BlockTax]);
+    blockBribe.push_back(r.blocks[BlockBribe]);
+    blockCoup.push_back(r.blocks[BlockCoup]);
+    seatRoles.push_back(r.seatRoles);
+    seatBots.push_back(r.seatBots);
+}
+
+GameRecord RowGroup::row(std::size_t i) const {
+    GameRecord r;
+    r.id = id[i];  r.ticks = ticks[i];  r.players = players[i];
+    r.winnerSeat = winnerSeat[i];  r.winnerRole = winnerRole[i];
+    r.blocks = {blockTax[i], blockBribe[i], blockCoup[i]};
+    r.seatRoles = seatRoles[i];  r.seatBots = seatBots[i];
+    return r;
+}
+
+void RowGroup::clear() {
+    forEachColumn([](const char*, auto& col){ col.clear(); });
+}
+
+/* ── columnar file ────────────────────────────────────────── */
+static constexpr char kMagic[8] = {'C','O','U','P','C','O','L','1'};
+
+ColumnarWriter::ColumnarWriter(const std::string& path)
+    : f_(std::fopen(path.c_str(), "wb"))
+{
+    if(!f_) throw std::runtime_error("cannot open " + path);
+
+    RowGroup schema;
+    std::uint32_t cols = 0;
+    schema.forEachColumn([&](const char*, auto&){ ++cols; });
+    std::fwrite(kMagic, 1, sizeof kMagic, f_);
+    std::fwrite(&cols, sizeof cols, 1, f_);
+    schema.forEachColumn([&](const char* name, auto& col){
+        const auto len   = static_cast<std::uint8_t>(std::strlen(name));
+        const auto width = static_cast<std::uint8_t>(sizeof(col[0]));
+        std::fwrite(&len, 1, 1, f_);
+        std::fwrite(name, 1, len, f_);
+        std::fwrite(&width, 1, 1, f_);
+    });
+}
+
+ColumnarWriter::~ColumnarWriter() { std::fclose(f_); }
+
+void ColumnarWriter::write(RowGroup& g) {
+    if(!g.size()) return;
+    std::lock_guard<std::mutex> lock(m_);
+    const auto rows = static_cast<std::uint32_t>(g.size());
+    std::fwrite(&rows, sizeof rows, 1, f_);
+    g.forEachColumn([&](const char*, auto& col){
+        std::fwrite(col.data(), sizeof(col[0]), col.size(), f_);
+    });
+}
+
+ColumnarReader::ColumnarReader(const std::string& path)
+    : f_(std::fopen(path.c_str(), "rb"))
+{
+    if(!f_) throw std::runtime_error("cannot open " + path);
+
+    char magic[sizeof kMagic];
+    std::uint32_t cols = 0;
+    if(std::fread(magic, 1, sizeof magic, f_) != sizeof magic
+       || std::memcmp(magic, kMagic, sizeof kMagic) != 0
+       || std::fread(&cols, sizeof cols, 1, f_) != 1) {
+        std::fclose(f_);
+        throw std::runtime_error(path + ": not a columnar game file");
+    }
+    for(std::uint32_t c=0;c<cols;++c) {          // schema is fixed; skip it
+        std::uint8_t len = 0, width = 0;
+        char name[256];
+        if(std::fread(&len,1,1,f_)!=1 || std::fread(name,1,len,f_)!=len || std::fread(&width,1,1,f_)!=1) {
+            std::fclose(f_);
+            throw std::runtime_error(path + ": truncated header");
+        }
+    }
+}
+
+ColumnarReader::~ColumnarReader() { std::fclose(f_); }
+
+bool ColumnarReader::next(RowGroup& g) {
+    std::uint32_t rows = 0;
+    if(std::fread(&rows, sizeof rows, 1, f_) != 1) return false;
+    bool ok = true;
+    g.forEachColumn([&](const char*, auto& col){
+        col.resize(rows);
+        ok = ok && std::fread(col.data(), sizeof(col[0]), rows, f_) == rows;
+    });
+    if(!ok) throw std::runtime_error("columnar file: truncated row group");
+    for(std::uint32_t i=0;i<rows;++i) {
+        const GameRecord r = g.row(i);
+        ok = ok && r.players <= kMaxRecordSeats
+                && (r.winnerSeat == kNoSeat || r.winnerSeat < r.players);
+        for(std::size_t s=0; ok && s<r.players; ++s) ok = static_cast<std::size_t>(r.role(s)) < kRoleCount;
+    }
+    if(!ok) throw std::runtime_error("columnar file: row out of range");
+    return true;
+}
+
+/* ── the pipeline ─────────────────────────────────────────── */
+BalanceStats coup_sim::runBalanceStudy(const StudyConfig& cfg, ColumnarWriter* out, ArchiveWriter* archive)
+{
+    constexpr std::uint64_t kChunk = 256;                  // ids claimed per grab
+    const unsigned nThreads = std::max(1u, cfg.threads);
+
+    if(cfg.minPlayers < 2 || cfg.minPlayers > cfg.maxPlayers || cfg.maxPlayers > kMaxRecordSeats)
+        throw std::invalid_argument("player count must satisfy 2 <= min <= max <= 16");
+    if(cfg.bots.empty() || cfg.bots.size() > 16)
+        throw std::invalid_argument("need 1..16 bots");
+    for(const auto& b : cfg.bots) makeBot(b);              // unknown name → throws here
+
+    std::atomic<std::uint64_t> nextId{0};
+    std::vector<BalanceStats>  partial(nThreads);
+
+    auto worker = [&](unsigned w) {
+        std::vector<std::unique_ptr<Bot>> bots;
+        for(const auto& b : cfg.bots) bots.push_back(makeBot(b));
+        BalanceStats&           stats = partial[w];
+        RowGroup                group;
+        std::vector<Role>        roles;
+        std::vector<std::size_t> botIds;
+        std::vector<Bot*>        seatBots;
+        std::vector<ArchivedGame> played;
+
+        for(;;) {
+            const std::uint64_t first = nextId.fetch_add(kChunk);
+            if(first >= cfg.games) break;
+            const std::uint64_t last = std::min(cfg.games, first + kChunk);
+            if(archive) played.resize(last - first);
+
+            for(std::uint64_t id=first; id<last; ++id) {
+                Rng rng(cfg.seed * 0x100000001B3ull ^ id);
+                const std::size_t n = cfg.minPlayers + rng.below(cfg.maxPlayers - cfg.minPlayers + 1);
+                roles.clear(); botIds.clear(); seatBots.clear();
+                for(std::size_t i=0;i<n;++i) {
+                    roles.push_back(static_cast<Role>(rng.below(kRoleCount)));
+                    botIds.push_back(rng.below(bots.size()));
+                    seatBots.push_back(bots[botIds.back()].get());
+                }
+
+                Table t = Table::deal(roles);
+                ArchivedGame* log    = archive ? &played[id - first] : nullptr;
+                if(log) log->actions.clear();
+                const GameResult r   = playGame(*t.game, seatBots, rng, cfg.maxTicks, log ? &log->actions : nullptr);
+                const GameRecord rec = makeRecord(id, roles, botIds, r);
+                if(log) { log->id = id; log->roles = roles; log->winner = r.winner; }
+                stats.add(rec);
+                if(out) {
+                    group.push(rec);
+                    if(group.full()) { out->write(group); group.clear(); }
+                }
+            }
+            if(archive) archive->writeBlock(played);
+        }
+        if(out) out->write(group);
+    };
+
+    std::vector<std::thread> pool;
+    for(unsigned w=1; w<nThreads; ++w) pool.emplace_back(worker, w);
+    worker(0);
+    for(auto& t : pool) t.join();
+
+    BalanceStats total;
+    for(const auto& p : partial) total.merge(p);
+    return total;
+}
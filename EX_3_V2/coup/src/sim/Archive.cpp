@@ -0,0 +1,304 @@
+// thelet.shevach@gmail.com
+#include "sim/Archive.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace coup_sim {
+
+namespace {
+
+constexpr char        kHeadMagic[8] = {'C','O','U','P','A','R','C','1'};
+constexpr char        kFootMagic[8] = {'C','O','U','P','A','R','C','F'};
+constexpr std::size_t kRefBytes     = 32;
+constexpr std::size_t kTrailBytes   = 24;
+
+using coup::Action;
+
+/* seats are stored in just enough bits for the table */
+unsigned seatBits(std::size_t players) {
+    unsigned b = 1;
+    while((std::size_t{1} << b) < players) ++b;
+    return b;
+}
+
+bool keepsTarget(Action::Type t) {
+    return t == Action::Type::Arrest || t == Action::Type::Sanction
+        || t == Action::Type::Coup   || t == Action::Type::SpyPeek;
+}
+
+/* ── varints and bits ────────────────────────────────────────── */
+void putVarint(std::vector<unsigned char>& out, std::uint64_t v) {
+    while(v >= 0x80) { out.push_back(static_cast<unsigned char>(v | 0x80)); v >>= 7; }
+    out.push_back(static_cast<unsigned char>(v));
+}
+
+template<class T> void put(std::vector<unsigned char>& out, T v) {
+    const auto at = out.size();
+    out.resize(at + sizeof v);
+    std::memcpy(out.data() + at, &v, sizeof v);
+}
+template<class T> T get(const unsigned char* p) {
+    T v;
+    std::memcpy(&v, p, sizeof v);
+    return v;
+}
+
+/* LSB-first bit packer */
+struct BitWriter {
+    std::vector<unsigned char>& out;
+    std::uint64_t acc{0};
+    unsigned      n{0};
+
+    void put(std::uint64_t v, unsigned bits) {
+        acc |= v << n;
+        n   += bits;
+        while(n >= 8) { out.push_back(static_cast<unsigned char>(acc)); acc >>= 8; n -= 8; }
+    }
+    void flush() { if(n) out.push_back(static_cast<unsigned char>(acc)); acc = 0; n = 0; }
+};
+
+/* refills a whole word at a time; reading up to 8 bytes past a payload
+   is safe because the footer always follows the last block            */
+struct BitReader {
+    const unsigned char* p;
+    std::uint64_t acc{0};
+    unsigned      n{0};
+
+    std::uint64_t get(unsigned bits) {
+        if(n < bits) {
+            std::uint64_t w;
+            std::memcpy(&w, p, sizeof w);
+            acc |= w << n;                         // n < bits <= 4 here
+            const unsigned take = (63 - n) / 8;
+            p += take;
+            n += take * 8;
+        }
+        const std::uint64_t v = acc & ((std::uint64_t{1} << bits) - 1);
+        acc >>= bits;
+        n   -= bits;
+        return v;
+    }
+};
+
+void encode(std::vector<unsigned char>& out, const ArchivedGame& g, std::uint64_t prevId) {
+    const std::size_t n = g.roles.size();
+    if(n < 2 || n > 16) throw std::invalid_argument("archive: tables seat 2..16 players");
+    putVarint(out, g.id - prevId);
+    putVarint(out, n);
+    for(std::size_t i=0;i<n;i+=2) {
+        const unsigned lo = static_cast<unsigned>(g.roles[i]);
+        const unsigned hi = i + 1 < n ? static_cast<unsigned>(g.roles[i+1]) : 0;
+        out.push_back(static_cast<unsigned char>(lo | hi << 4));
+    }
+    putVarint(out, g.winner == GameResult::noWinner ? 0 : g.winner + 1);
+    putVarint(out, g.actions.size());
+
+    std::vector<unsigned char> bits;
+    BitWriter w{bits};
+    const unsigned sb = seatBits(n);
+    for(const Action& a : g.actions) {
+        if(a.actor >= n) throw std::invalid_argument("archive: actor outside the table");
+        w.put(static_cast<unsigned>(a.type), 4);
+        w.put(a.actor, sb);
+        if(keepsTarget(a.type)) {
+            if(!a.target || *a.target >= n) throw std::invalid_argument("archive: missing or bad target");
+            w.put(*a.target, sb);
+        }
+    }
+    w.flush();
+    putVarint(out, bits.size());
+    out.insert(out.end(), bits.begin(), bits.end());
+}
+
+} // namespace
+
+/* ── writer ──────────────────────────────────────────────────── */
+ArchiveWriter::ArchiveWriter(const std::string& path, std::size_t gamesPerBlock)
+    : f_(std::fopen(path.c_str(), "wb")), perBlock_(std::max<std::size_t>(gamesPerBlock, 1))
+{
+    if(!f_) throw std::runtime_error("cannot open " + path);
+    if(std::fwrite(kHeadMagic, 1, sizeof kHeadMagic, f_) != sizeof kHeadMagic) {
+        std::fclose(f_);
+        throw std::runtime_error("archive: write failed");
+    }
+    offset_ = sizeof kHeadMagic;
+}
+
+ArchiveWriter::~ArchiveWriter() {
+    try { close(); } catch(...) {}
+}
+
+void ArchiveWriter::add(const ArchivedGame& g) {
+    if(!open_.empty() && g.id <= open_.back().id) throw std::invalid_argument("archive: ids must increase");
+    open_.push_back(g);
+    if(open_.size() >= perBlock_) { writeBlock(open_); open_.clear(); }
+}
+
+void ArchiveWriter::writeBlock(const std::vector<ArchivedGame>& games) {
+    if(games.empty()) return;
+    std::vector<unsigned char> buf;
+    putVarint(buf, games.size());
+    std::uint64_t prev = games.front().id;
+    for(std::size_t k=0;k<games.size();++k) {
+        if(k && games[k].id <= prev) throw std::invalid_argument("archive: ids must increase");
+        encode(buf, games[k], prev);
+        prev = games[k].id;
+    }
+    if(buf.size() > UINT32_MAX) throw std::invalid_argument("archive: block too large");
+
+    std::lock_guard<std::mutex> lock(m_);
+    if(!f_) throw std::logic_error("archive already closed");
+    if(std::fwrite(buf.data(), 1, buf.size(), f_) != buf.size()) throw std::runtime_error("archive: write failed");
+    blocks_.push_back({games.front().id, games.back().id, offset_,
+                       static_cast<std::uint32_t>(games.size()), static_cast<std::uint32_t>(buf.size())});
+    offset_ += buf.size();
+}
+
+void ArchiveWriter::close() {
+    if(!f_) return;
+    if(!open_.empty()) { writeBlock(open_); open_.clear(); }
+
+    std::lock_guard<std::mutex> lock(m_);
+    std::sort(blocks_.begin(), blocks_.end(), [](const BlockRef& a, const BlockRef& b){ return a.first < b.first; });
+    std::vector<unsigned char> foot;
+    for(const BlockRef& b : blocks_) {
+        put(foot, b.first); put(foot, b.last); put(foot, b.offset);
+        put(foot, b.games); put(foot, b.bytes);
+    }
+    put(foot, static_cast<std::uint64_t>(blocks_.size()));
+    put(foot, offset_);
+    foot.insert(foot.end(), kFootMagic, kFootMagic + sizeof kFootMagic);
+
+    const bool ok = std::fwrite(foot.data(), 1, foot.size(), f_) == foot.size();
+    const bool closed = std::fclose(f_) == 0;
+    f_ = nullptr;
+    if(!ok || !closed) throw std::runtime_error("archive: write failed");
+}
+
+/* ── reader ──────────────────────────────────────────────────── */
+ArchiveReader::ArchiveReader(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) throw std::runtime_error("cannot open " + path);
+    struct stat st{};
+    if(::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof kHeadMagic + kTrailBytes) {
+        ::close(fd);
+        throw std::runtime_error("bad archive " + path);
+    }
+    bytes_ = static_cast<std::size_t>(st.st_size);
+    void* m = ::mmap(nullptr, bytes_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(m == MAP_FAILED) throw std::runtime_error("cannot map " + path);
+    base_ = static_cast<const unsigned char*>(m);
+
+    auto fail = [&](const char* why) {
+        ::munmap(const_cast<unsigned char*>(base_), bytes_);
+        base_ = nullptr;
+        throw std::runtime_error(path + ": " + why);
+    };
+    const unsigned char* trail = base_ + bytes_ - kTrailBytes;
+    if(std::memcmp(base_, kHeadMagic, sizeof kHeadMagic) != 0
+       || std::memcmp(trail + 16, kFootMagic, sizeof kFootMagic) != 0) fail("not a replay archive");
+
+    const auto nBlocks = get<std::uint64_t>(trail);
+    const auto footAt  = get<std::uint64_t>(trail + 8);
+    if(footAt < sizeof kHeadMagic || footAt > bytes_ - kTrailBytes
+       || nBlocks != (bytes_ - kTrailBytes - footAt) / kRefBytes
+       || (bytes_ - kTrailBytes - footAt) % kRefBytes) fail("corrupt footer");
+
+    index_.resize(nBlocks);
+    for(std::size_t b=0;b<nBlocks;++b) {
+        const unsigned char* r = base_ + footAt + b * kRefBytes;
+        BlockRef& ref = index_[b];
+        ref = {get<std::uint64_t>(r), get<std::uint64_t>(r + 8), get<std::uint64_t>(r + 16),
+               get<std::uint32_t>(r + 24), get<std::uint32_t>(r + 28)};
+        if(ref.first > ref.last || ref.offset < sizeof kHeadMagic || ref.offset + ref.bytes > footAt)
+            fail("corrupt block index");
+        if(b && ref.first <= index_[b-1].last) fail("overlapping blocks");
+        games_ += ref.games;
+    }
+}
+
+ArchiveReader::~ArchiveReader() {
+    if(base_) ::munmap(const_cast<unsigned char*>(base_), bytes_);
+}
+
+std::uint64_t ArchiveReader::readVarint(const unsigned char*& p, const unsigned char* end) {
+    std::uint64_t v = 0;
+    for(unsigned shift=0; p<end && shift<64; shift+=7) {
+        const unsigned char c = *p++;
+        v |= std::uint64_t{c & 0x7Fu} << shift;
+        if(!(c & 0x80)) return v;
+    }
+    throw std::runtime_error("archive: corrupt block");
+}
+
+/* everything is checked against the block: a bad byte throws, it never
+   reads past `end` (BitReader's look-ahead stays inside the footer)     */
+void ArchiveReader::decode(const unsigned char*& p, const unsigned char* end, ArchivedGame& g, bool actions) {
+    auto corrupt = []{ throw std::runtime_error("archive: corrupt block"); };
+    g.id += readVarint(p, end);
+    const std::size_t n = readVarint(p, end);
+    if(n < 2 || n > 16 || static_cast<std::size_t>(end - p) < (n + 1) / 2) corrupt();
+    g.roles.resize(n);
+    for(std::size_t i=0;i<n;++i) {
+        const unsigned r = p[i/2] >> (i % 2 * 4) & 0xF;
+        if(r >= kRoleCount) corrupt();
+        g.roles[i] = static_cast<Role>(r);
+    }
+    p += (n + 1) / 2;
+    const std::uint64_t w = readVarint(p, end);
+    if(w > n) corrupt();
+    g.winner = w ? w - 1 : GameResult::noWinner;
+    const std::size_t count = readVarint(p, end);
+    const std::size_t bytes = readVarint(p, end);
+    if(bytes > static_cast<std::size_t>(end - p)) corrupt();
+
+    g.actions.clear();
+    if(actions) {
+        const unsigned sb = seatBits(n);
+        if(count > bytes * 8 / (4 + sb)) corrupt();
+        g.actions.resize(count);
+        BitReader r{p};
+        std::size_t bits = bytes * 8;
+        auto take = [&](unsigned k) { if(bits < k) corrupt(); bits -= k; return r.get(k); };
+        for(Action& a : g.actions) {
+            const auto type = take(4);
+            if(type > static_cast<unsigned>(Action::Type::SpyPeek)) corrupt();
+            a.type   = static_cast<Action::Type>(type);
+            a.actor  = take(sb);
+            a.target = keepsTarget(a.type) ? std::optional<std::size_t>(take(sb)) : std::nullopt;
+            if(a.actor >= n || (a.target && *a.target >= n)) corrupt();
+        }
+    }
+    p += bytes;
+}
+
+bool ArchiveReader::find(std::uint64_t id, ArchivedGame& out) const {
+    auto it = std::upper_bound(index_.begin(), index_.end(), id,
+                               [](std::uint64_t v, const BlockRef& b){ return v < b.first; });
+    if(it == index_.begin()) return false;
+    const BlockRef& b = *--it;
+    if(id > b.last) return false;
+
+    const unsigned char* p   = base_ + b.offset;
+    const unsigned char* end = p + b.bytes;
+    const std::uint64_t  n   = readVarint(p, end);
+    out.id = b.first;
+    for(std::uint64_t k=0;k<n;++k) {
+        /* peek at the id; unpack the payload of the one game asked for */
+        const unsigned char* q = p;
+        const std::uint64_t  at = out.id + readVarint(q, end);
+        if(at > id) return false;
+        decode(p, end, out, at == id);
+        if(at == id) return true;
+    }
+    return false;
+}
+
+} // namespace coup_sim
@@ -0,0 +1,194 @@
+// thelet.shevach@gmail.com
+#include "sim/Bitmap.hpp"
+#include <algorithm>
+
+namespace coup_sim {
+
+/* ── one chunk ────────────────────────────────────────────── */
+void Bitmap::toBitset(Chunk& c) {
+    if(!c.words.empty()) return;
+    c.words.assign(kWords, 0);
+    for(std::uint16_t lo : c.ids) c.words[lo >> 6] |= std::uint64_t{1} << (lo & 63);
+    c.ids.clear();
+    c.ids.shrink_to_fit();
+}
+
+void Bitmap::shrink(Chunk& c) {
+    if(c.words.empty() || c.count > kArrayMax) return;
+    c.ids.reserve(c.count);
+    for(std::uint32_t w=0; w<kWords; ++w)
+        for(std::uint64_t bits = c.words[w]; bits; bits &= bits - 1)
+            c.ids.push_back(static_cast<std::uint16_t>(w << 6 | static_cast<std::uint32_t>(__builtin_ctzll(bits))));
+    c.words.clear();
+    c.words.shrink_to_fit();
+}
+
+Bitmap::Chunk Bitmap::combine(const Chunk& a, const Chunk& b, Op op) {
+    Chunk out;
+    out.key = a.key;
+    const bool aBits = !a.words.empty(), bBits = !b.words.empty();
+
+    if(aBits && bBits) {
+        out.words.resize(kWords);
+        for(std::uint32_t w=0; w<kWords; ++w) {
+            const std::uint64_t v = op == Op::And ? a.words[w] &  b.words[w]
+                                  : op == Op::Or  ? a.words[w] |  b.words[w]
+                                  :                 a.words[w] & ~b.words[w];
+            out.words[w] = v;
+            out.count   += static_cast<std::uint32_t>(__builtin_popcountll(v));
+        }
+        shrink(out);
+        return out;
+    }
+    auto has = [](const Chunk& bits, std::uint16_t lo) { return bits.words[lo >> 6] >> (lo & 63) & 1; };
+
+    if(op == Op::Or && (aBits || bBits)) {
+        out.words = aBits ? a.words : b.words;
+        out.count = aBits ? a.count : b.count;
+        for(std::uint16_t lo : (aBits ? b : a).ids) {
+            std::uint64_t& w = out.words[lo >> 6];
+            const std::uint64_t m = std::uint64_t{1} << (lo & 63);
+            if(!(w & m)) { w |= m; ++out.count; }
+        }
+        return out;
+    }
+    if(aBits) {                                    // bitset AND / AND NOT array
+        if(op == Op::And) {
+            for(std::uint16_t lo : b.ids) if(has(a, lo)) out.ids.push_back(lo);
+            out.count = static_cast<std::uint32_t>(out.ids.size());
+            return out;
+        }
+        out.words = a.words;
+        out.count = a.count;
+        for(std::uint16_t lo : b.ids) if(has(a, lo)) { out.words[lo >> 6] &= ~(std::uint64_t{1} << (lo & 63)); --out.count; }
+        shrink(out);
+        return out;
+    }
+    if(bBits) {                                    // array AND / AND NOT bitset
+        for(std::uint16_t lo : a.ids) if(has(b, lo) == (op == Op::And)) out.ids.push_back(lo);
+        out.count = static_cast<std::uint32_t>(out.ids.size());
+        return out;
+    }
+
+    /* two arrays: a merge */
+    const auto& x = a.ids;
+    const auto& y = b.ids;
+    if(op == Op::And)      std::set_intersection(x.begin(), x.end(), y.begin(), y.end(), std::back_inserter(out.ids));
+    else if(op == Op::Or)  std::set_union       (x.begin(), x.end(), y.begin(), y.end(), std::back_inserter(out.ids));
+    else                   std::set_difference  (x.begin(), x.end(), y.begin(), y.end(), std::back_inserter(out.ids));
+    out.count = static_cast<std::uint32_t>(out.ids.size());
+    if(out.count > kArrayMax) toBitset(out);
+    return out;
+}
+
+/* ── the set ──────────────────────────────────────────────── */
+void Bitmap::add(std::uint32_t v) {
+    const auto key = static_cast<std::uint16_t>(v >> 16);
+    const auto lo  = static_cast<std::uint16_t>(v);
+
+    auto it = chunks_.end();
+    if(chunks_.empty() || chunks_.back().key < key) {
+        chunks_.push_back({key, 0, {}, {}});
+        it = chunks_.end() - 1;
+    } else if(chunks_.back().key == key) {
+        it = chunks_.end() - 1;
+    } else {
+        it = std::lower_bound(chunks_.begin(), chunks_.end(), key,
+                              [](const Chunk& c, std::uint16_t k){ return c.key < k; });
+        if(it == chunks_.end() || it->key != key) it = chunks_.insert(it, Chunk{key, 0, {}, {}});
+    }
+
+    Chunk& c = *it;
+    if(!c.words.empty()) {
+        std::uint64_t& w = c.words[lo >> 6];
+        const std::uint64_t m = std::uint64_t{1} << (lo & 63);
+        if(!(w & m)) { w |= m; ++c.count; }
+        return;
+    }
+    if(c.ids.empty() || c.ids.back() < lo) c.ids.push_back(lo);
+    else {
+        auto at = std::lower_bound(c.ids.begin(), c.ids.end(), lo);
+        if(*at == lo) return;
+        c.ids.insert(at, lo);
+    }
+    if(++c.count > kArrayMax) toBitset(c);
+}
+
+bool Bitmap::contains(std::uint32_t v) const {
+    const auto key = static_cast<std::uint16_t>(v >> 16);
+    const auto lo  = static_cast<std::uint16_t>(v);
+    auto it = std::lower_bound(chunks_.begin(), chunks_.end(), key,
+                               [](const Chunk& c, std::uint16_t k){ return c.key < k; });
+    if(it == chunks_.end() || it->key != key) return false;
+    if(!it->words.empty()) return it->words[lo >> 6] >> (lo & 63) & 1;
+    return std::binary_search(it->ids.begin(), it->ids.end(), lo);
+}
+
+std::uint64_t Bitmap::size() const {
+    std::uint64_t n = 0;
+    for(const Chunk& c : chunks_) n += c.count;
+    return n;
+}
+
+std::vector<std::uint32_t> Bitmap::ids() const {
+    std::vector<std::uint32_t> out;
+    out.reserve(size());
+    forEach([&](std::uint32_t v){ out.push_back(v); });
+    return out;
+}
+
+Bitmap Bitmap::range(std::uint32_t n) {
+    Bitmap out;
+    for(std::uint32_t key=0; std::uint64_t{key} << 16 < n; ++key) {
+        Chunk c;
+        c.key   = static_cast<std::uint16_t>(key);
+        c.count = static_cast<std::uint32_t>(std::min<std::uint64_t>(n - (std::uint64_t{key} << 16), 1u << 16));
+        c.words.assign(kWords, 0);
+        for(std::uint32_t w=0; w < c.count / 64; ++w) c.words[w] = ~std::uint64_t{0};
+        if(c.count % 64) c.words[c.count / 64] = (std::uint64_t{1} << (c.count % 64)) - 1;
+        shrink(c);
+        out.chunks_.push_back(std::move(c));
+    }
+    return out;
+}
+
+/* chunks pair up by key; unmatched ones survive OR (and the left side of
+   AND NOT) untouched                                                      */
+Bitmap operator&(const Bitmap& a, const Bitmap& b) {
+    Bitmap out;
+    auto i = a.chunks_.begin(), j = b.chunks_.begin();
+    while(i != a.chunks_.end() && j != b.chunks_.end()) {
+        if(i->key < j->key) ++i;
+        else if(j->key < i->key) ++j;
+        else {
+            Bitmap::Chunk c = Bitmap::combine(*i++, *j++, Bitmap::Op::And);
+            if(c.count) out.chunks_.push_back(std::move(c));
+        }
+    }
+    return out;
+}
+
+Bitmap operator|(const Bitmap& a, const Bitmap& b) {
+    Bitmap out;
+    auto i = a.chunks_.begin(), j = b.chunks_.begin();
+    while(i != a.chunks_.end() || j != b.chunks_.end()) {
+        if(j == b.chunks_.end() || (i != a.chunks_.end() && i->key < j->key)) out.chunks_.push_back(*i++);
+        else if(i == a.chunks_.end() || j->key < i->key)                       out.chunks_.push_back(*j++);
+        else out.chunks_.push_back(Bitmap::combine(*i++, *j++, Bitmap::Op::Or));
+    }
+    return out;
+}
+
+Bitmap operator-(const Bitmap& a, const Bitmap& b) {
+    Bitmap out;
+    auto j = b.chunks_.begin();
+    for(const Bitmap::Chunk& c : a.chunks_) {
+        while(j != b.chunks_.end() && j->key < c.key) ++j;
+        if(j == b.chunks_.end() || j->key != c.key) { out.chunks_.push_back(c); continue; }
+        Bitmap::Chunk d = Bitmap::combine(c, *j, Bitmap::Op::AndNot);
+        if(d.count) out.chunks_.push_back(std::move(d));
+    }
+    return out;
+}
+
+} // namespace coup_sim
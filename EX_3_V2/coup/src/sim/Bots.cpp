@@ -0,0 +1,51 @@
+// thelet.shevach@gmail.com
+#include "sim/Bots.hpp"
+#include "sim/Ismcts.hpp"
+#include "sim/Table.hpp"
+#include "core/Player.hpp"
+#include <stdexcept>
+
+using namespace coup_sim;
+using coup::Action;
+using coup::Game;
+
+/* ── RandomBot ────────────────────────────────────────────── */
+Action RandomBot::choose(const Game&, const std::vector<Action>& moves, Rng& rng) {
+    return moves[rng.below(moves.size())];
+}
+
+bool RandomBot::react(const Game&, std::size_t, Rng& rng) {
+    return rng.uniform() < blockRate_;
+}
+
+/* ── GreedyBot ────────────────────────────────────────────── */
+static int greedyScore(const Game& g, const Action& a) {
+    const auto& roster = g.roster();
+    switch(a.type) {
+    case Action::Type::Coup:     return 100 + g.coins(*a.target);
+    case Action::Type::Invest:   return 30;
+    case Action::Type::Tax:      return roleOf(*roster[a.actor]) == Role::Governor ? 25 : 20;
+    case Action::Type::Arrest:   return 15;
+    case Action::Type::Gather:   return 10;
+    case Action::Type::Sanction: return 5;
+    default:                     return 0;               // Bribe wastes 4
+    }
+}
+
+Action GreedyBot::choose(const Game& g, const std::vector<Action>& moves, Rng& rng) {
+    std::size_t best = 0;
+    int         bestScore = -1;
+    for(std::size_t i=0;i<moves.size();++i) {
+        const int s = greedyScore(g, moves[i]) * 4 + static_cast<int>(rng.below(4));
+        if(s > bestScore) { bestScore = s; best = i; }
+    }
+    return moves[best];
+}
+
+/* ── factory ──────────────────────────────────────────────── */
+std::unique_ptr<Bot> coup_sim::makeBot(const std::string& name) {
+    if(name == "random") return std::make_unique<RandomBot>();
+    if(name == "greedy") return std::make_unique<GreedyBot>();
+    if(name == "ismcts") return std::make_unique<IsmctsBot>();
+    throw std::invalid_argument("unknown bot: " + name);
+}
@@ -0,0 +1,209 @@
+// thelet.shevach@gmail.com
+#include "sim/Cfr.hpp"
+#include "sim/MoveGen.hpp"
+#include "sim/Simulator.hpp"
+#include "sim/Table.hpp"
+#include "core/Player.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+using namespace coup_sim;
+using coup::Action;
+using coup::Game;
+
+/* ── information sets ─────────────────────────────────────── */
+static unsigned coinBucket(int c) {
+    return c<=0 ? 0 : c<=2 ? 1 : c<=4 ? 2 : c<=6 ? 3 : c<=9 ? 4 : 5;
+}
+static unsigned phaseBucket(std::size_t turns) {
+    return turns<=1 ? 0 : turns<=3 ? 1 : turns<=6 ? 2 : turns<=10 ? 3 : 4;
+}
+
+std::uint16_t coup_sim::reactionKey(const Game& g, std::size_t reactor) {
+    const Action*     src   = g.blockable();
+    const std::size_t alive = std::max<std::size_t>(aliveCount(g), 2);
+    unsigned kind = 3;
+    if(src) kind = src->type==Action::Type::Tax ? 0 : src->type==Action::Type::Bribe ? 1 : 2;
+    const bool victim = src && src->type==Action::Type::Coup && src->target==reactor;
+
+    return static_cast<std::uint16_t>(
+           kind
+         | coinBucket(g.coins(reactor))             << 2
+         | phaseBucket(g.tick() / alive)            << 5
+         | (std::min<std::size_t>(alive, 6) - 2)    << 8
+         | unsigned(victim)                         << 11);
+}
+
+/* ── ReactionTable ────────────────────────────────────────── */
+static constexpr char kMagic[8] = {'C','O','U','P','C','F','R','1'};
+
+void ReactionTable::setBlockProb(std::uint16_t key, double p) {
+    prob_[key] = static_cast<std::uint8_t>(std::lround(std::clamp(p, 0.0, 1.0) * 255.0));
+}
+
+void ReactionTable::save(const std::string& path) const {
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if(!f) throw std::runtime_error("cannot open " + path);
+    bool ok = std::fwrite(kMagic, 1, sizeof kMagic, f) == sizeof kMagic
+           && std::fwrite(prob_.data(), 1, prob_.size(), f) == prob_.size();
+    ok = (std::fclose(f) == 0) && ok;
+    if(!ok) throw std::runtime_error("cannot write " + path);
+}
+
+void ReactionTable::load(const std::string& path) {
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if(!f) throw std::runtime_error("cannot open " + path);
+    char magic[sizeof kMagic];
+    decltype(prob_) p;
+    const bool ok = std::fread(magic, 1, sizeof magic, f) == sizeof magic
+                 && std::memcmp(magic, kMagic, sizeof kMagic) == 0
+                 && std::fread(p.data(), 1, p.size(), f) == p.size();
+    std::fclose(f);
+    if(!ok) throw std::runtime_error(path + ": not a reaction table");
+    prob_ = p;
+}
+
+/* ── trainer ──────────────────────────────────────────────── */
+struct CfrTrainer::Local {
+    std::vector<double>        regret, average;
+    std::vector<std::uint64_t> visits;
+    ReactionTable              snapshot;
+    std::uint64_t              round{0};
+};
+
+CfrTrainer::CfrTrainer(const CfrConfig& cfg)
+    : cfg_(cfg), regret_(2*kReactionKeys, 0.0), average_(2*kReactionKeys, 0.0),
+      visits_(kReactionKeys, 0)
+{
+    if(cfg_.minPlayers < 2 || cfg_.maxPlayers < cfg_.minPlayers)
+        throw std::invalid_argument("cfr: bad player range");
+    if(cfg_.rollouts == 0) throw std::invalid_argument("cfr: rollouts must be at least 1");
+    if(cfg_.epoch == 0)    throw std::invalid_argument("cfr: epoch must be at least 1");
+}
+
+void CfrTrainer::merge(Local& l) {
+    std::lock_guard<std::mutex> lock(m_);
+    for(std::size_t i=0;i<regret_.size();++i) {
+        regret_[i]   = std::max(0.0, regret_[i] + l.regret[i]);        // CFR+
+        average_[i] += l.average[i];
+        l.regret[i] = l.average[i] = 0.0;
+    }
+    for(std::size_t k=0;k<kReactionKeys;++k) {
+        visits_[k] += l.visits[k];
+        l.visits[k] = 0;
+        const double sum = regret_[2*k] + regret_[2*k+1];
+        current_.setBlockProb(static_cast<std::uint16_t>(k), sum > 0 ? regret_[2*k+1] / sum : 0.5);
+    }
+    l.snapshot = current_;
+    l.round    = ++round_;
+}
+
+void CfrTrainer::worker(unsigned w, std::uint64_t windows) {
+    Rng rng(cfg_.seed * 0x100000001B3ull + w + 1);
+    GreedyBot greedy;
+    RandomBot random;
+
+    Local l;
+    l.regret.assign(regret_.size(), 0.0);
+    l.average.assign(average_.size(), 0.0);
+    l.visits.assign(kReactionKeys, 0);
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        l.snapshot = current_;
+        l.round    = round_;
+    }
+
+    std::vector<Action>                  moves;
+    std::vector<std::size_t>             eligible;
+    std::vector<std::unique_ptr<CfrBot>> owned;
+    std::vector<Bot*>                    bots;
+    std::uint64_t done = 0;
+
+    while(done < windows) {
+        std::vector<Role> roles(cfg_.minPlayers + rng.below(cfg_.maxPlayers - cfg_.minPlayers + 1));
+        for(auto& r : roles) r = static_cast<Role>(rng.below(kRoleCount));
+        Table t       = Table::deal(roles);
+        Table scratch = Table::deal(roles);
+        Game& g       = *t.game;
+        owned.clear();
+        bots.clear();
+        for(std::size_t i=0;i<roles.size();++i) {
+            owned.push_back(std::make_unique<CfrBot>(rng.below(2) ? static_cast<Bot&>(greedy) : random, l.snapshot));
+            bots.push_back(owned.back().get());
+        }
+
+        while(done < windows && g.tick() < cfg_.maxTicks && aliveCount(g) > 1) {
+            const std::size_t me = g.turnIndex();
+            moves.clear();
+            legalMoves(g, moves);
+            if(moves.empty()) break;
+            const Action a = bots[me]->choose(g, moves, rng);
+            if(!blockable(a.type)) { apply(g, a); continue; }
+
+            g.propose(a);
+            eligible.clear();
+            for(std::size_t k=1;k<roles.size();++k)
+                if(canBlock(g, (me+k) % roles.size())) eligible.push_back((me+k) % roles.size());
+            if(eligible.empty()) { g.commit(); continue; }
+
+            /* value both choices for every eligible reactor */
+            const Game::State before = g.state();
+            for(std::size_t p : eligible) {
+                const std::uint16_t key = reactionKey(g, p);
+                double u[2] = {0, 0};
+                for(int act=0; act<2; ++act) {
+                    for(std::size_t r=0;r<cfg_.rollouts;++r) {
+                        Game& s = *scratch.game;
+                        s.load(before);
+                        for(std::size_t q : eligible)
+                            if(q==p ? act==1 : bots[q]->react(s, q, rng)) {
+                                s.block({Action::Type::Block, q, {}});
+                                break;
+                            }
+                        if(s.pending()) s.commit();
+                        u[act] += playGame(s, bots, rng, cfg_.maxTicks).winner == p;
+                    }
+                    u[act] /= double(cfg_.rollouts);
+                }
+                const double sigma  = l.snapshot.blockProb(key);
+                const double uSigma = sigma * u[1] + (1 - sigma) * u[0];
+                const double weight = double(l.round + 1);                // linear averaging
+                l.regret[2*key]    += u[0] - uSigma;
+                l.regret[2*key+1]  += u[1] - uSigma;
+                l.average[2*key]   += weight * (1 - sigma);
+                l.average[2*key+1] += weight * sigma;
+                ++l.visits[key];
+            }
+
+            /* and play the window out for real */
+            for(std::size_t q : eligible)
+                if(bots[q]->react(g, q, rng)) { g.block({Action::Type::Block, q, {}}); break; }
+            if(g.pending()) g.commit();
+            if(++done % cfg_.epoch == 0) merge(l);
+        }
+    }
+    merge(l);
+}
+
+void CfrTrainer::train() {
+    const unsigned nThreads = std::max(1u, cfg_.threads);
+    std::vector<std::thread> pool;
+    for(unsigned w=1; w<nThreads; ++w)
+        pool.emplace_back(&CfrTrainer::worker, this, w, cfg_.windows * (w+1) / nThreads - cfg_.windows * w / nThreads);
+    worker(0, cfg_.windows / nThreads);
+    for(auto& t : pool) t.join();
+}
+
+ReactionTable CfrTrainer::averageStrategy() const {
+    ReactionTable t;
+    for(std::size_t k=0;k<kReactionKeys;++k) {
+        const double sum = average_[2*k] + average_[2*k+1];
+        t.setBlockProb(static_cast<std::uint16_t>(k), sum > 0 ? average_[2*k+1] / sum : 0.5);
+    }
+    return t;
+}
@@ -0,0 +1,269 @@
+// thelet.shevach@gmail.com
+#include "sim/Eval.hpp"
+#include "sim/MoveGen.hpp"
+#include "core/Player.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define COUP_EVAL_AVX2 1
+#endif
+
+using namespace coup_sim;
+using coup::Game;
+
+static_assert(kEvalSeats * kSeatFeatures + 4 <= kFeatures && kFeatures % 8 == 0);
+
+/* ── features ─────────────────────────────────────────────── */
+void coup_sim::extractFeatures(const Game::State& s, const std::vector<Role>& roles,
+                               std::size_t seat, float* out)
+{
+    std::fill(out, out + kFeatures, 0.0f);
+    const std::size_t n = s.seats.size();
+    const auto& me = s.seats[seat];
+    std::size_t alive = 0;
+
+    for(std::size_t k=0; k<n; ++k) {
+        const std::size_t j = (seat + k) % n;
+        const auto&    p = s.seats[j];
+        alive += p.alive;
+        if(k >= kEvalSeats) continue;
+
+        float* f = out + k * kSeatFeatures;
+        f[0] = p.alive;
+        f[1] = p.coins / 10.0f;
+        f[2 + static_cast<std::size_t>(roles[j])] = 1.0f;
+        f[8] = p.sanctionedUntil > s.tick;
+        f[9] = k && me.lastArrested == j;
+        f[10] = float((j + n - s.turn) % n) / float(n);
+    }
+    float* g = out + kEvalSeats * kSeatFeatures;
+    g[0] = float(alive) / float(n);
+    g[1] = s.blockable && s.blockable->actor == seat;
+    g[2] = s.blockable && s.blockable->actor != seat;
+    g[3] = std::min(1.0f, s.tick / 100.0f);
+}
+
+void coup_sim::extractFeatures(const Game& g, std::size_t seat, float* out) {
+    std::vector<Role> roles;
+    roles.reserve(g.roster().size());
+    for(const auto* p : g.roster()) roles.push_back(roleOf(*p));
+    extractFeatures(g.state(), roles, seat, out);
+}
+
+/* ── FeatureBatch ─────────────────────────────────────────── */
+FeatureBatch::FeatureBatch(std::size_t capacity)
+    : rows_(static_cast<float*>(std::aligned_alloc(32, std::max<std::size_t>(1, capacity) * kFeatures * sizeof(float)))),
+      capacity_(capacity)
+{
+    if(!rows_) throw std::bad_alloc();
+}
+
+/* ── model ────────────────────────────────────────────────── */
+EvalModel::EvalModel(Kind k) : kind_(k) {
+    std::fill(std::begin(w1),  std::end(w1),  0.0f);
+    std::fill(std::begin(b1),  std::end(b1),  0.0f);
+    std::fill(std::begin(w2),  std::end(w2),  0.0f);
+    std::fill(std::begin(lin), std::end(lin), 0.0f);
+}
+
+void EvalModel::randomize(Rng& rng, float scale) {
+    auto r = [&]{ return float(rng.uniform() * 2.0 - 1.0) * scale; };
+    for(auto& w : w1)  w = r();
+    for(auto& w : w2)  w = r();
+    for(auto& w : lin) w = r();
+}
+
+static inline float sigmoid(float x) { return 1.0f / (1.0f + std::exp(-x)); }
+
+void EvalModel::evaluateScalar(const float* rows, std::size_t n, float* out) const {
+    for(std::size_t r=0; r<n; ++r) {
+        const float* x = rows + r * kFeatures;
+        if(kind_ == Kind::Linear) {
+            float acc = linB;
+            for(std::size_t i=0;i<kFeatures;++i) acc += lin[i] * x[i];
+            out[r] = sigmoid(acc);
+            continue;
+        }
+        float h[kHidden];
+        std::copy(std::begin(b1), std::end(b1), h);
+        for(std::size_t i=0;i<kFeatures;++i)
+            for(std::size_t u=0;u<kHidden;++u) h[u] += x[i] * w1[i*kHidden + u];
+        float acc = b2;
+        for(std::size_t u=0;u<kHidden;++u) acc += std::max(0.0f, h[u]) * w2[u];
+        out[r] = sigmoid(acc);
+    }
+}
+
+#ifdef COUP_EVAL_AVX2
+__attribute__((target("avx2,fma")))
+static inline float hsum(__m256 v) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+
+/* output layer for one row's four hidden registers */
+__attribute__((target("avx2,fma")))
+static inline float mlpOut(const EvalModel& m, __m256 h0, __m256 h1, __m256 h2, __m256 h3) {
+    const __m256 zero = _mm256_setzero_ps();
+    __m256 acc = _mm256_mul_ps(_mm256_max_ps(h0, zero), _mm256_load_ps(m.w2));
+    acc = _mm256_fmadd_ps(_mm256_max_ps(h1, zero), _mm256_load_ps(m.w2 + 8),  acc);
+    acc = _mm256_fmadd_ps(_mm256_max_ps(h2, zero), _mm256_load_ps(m.w2 + 16), acc);
+    acc = _mm256_fmadd_ps(_mm256_max_ps(h3, zero), _mm256_load_ps(m.w2 + 24), acc);
+    return sigmoid(hsum(acc) + m.b2);
+}
+
+/* hidden layer: broadcast each input and FMA it into the 32 units.  Two
+   rows per pass share the weight loads and keep 8 FMA chains in flight. */
+__attribute__((target("avx2,fma")))
+static void mlpAvx2(const EvalModel& m, const float* rows, std::size_t n, float* out) {
+    static_assert(EvalModel::kHidden == 32);
+    std::size_t r = 0;
+    for(; r+2<=n; r+=2) {
+        const float* x = rows + r * kFeatures;
+        const float* y = x + kFeatures;
+        __m256 a0 = _mm256_load_ps(m.b1),      a1 = _mm256_load_ps(m.b1 + 8);
+        __m256 a2 = _mm256_load_ps(m.b1 + 16), a3 = _mm256_load_ps(m.b1 + 24);
+        __m256 c0 = a0, c1 = a1, c2 = a2, c3 = a3;
+        for(std::size_t i=0;i<kFeatures;++i) {
+            const __m256 xi = _mm256_broadcast_ss(x + i), yi = _mm256_broadcast_ss(y + i);
+            const float* w  = m.w1 + i * EvalModel::kHidden;
+            const __m256 w0 = _mm256_load_ps(w),      w1 = _mm256_load_ps(w + 8);
+            const __m256 w2 = _mm256_load_ps(w + 16), w3 = _mm256_load_ps(w + 24);
+            a0 = _mm256_fmadd_ps(xi, w0, a0);  c0 = _mm256_fmadd_ps(yi, w0, c0);
+            a1 = _mm256_fmadd_ps(xi, w1, a1);  c1 = _mm256_fmadd_ps(yi, w1, c1);
+            a2 = _mm256_fmadd_ps(xi, w2, a2);  c2 = _mm256_fmadd_ps(yi, w2, c2);
+            a3 = _mm256_fmadd_ps(xi, w3, a3);  c3 = _mm256_fmadd_ps(yi, w3, c3);
+        }
+        out[r]     = mlpOut(m, a0, a1, a2, a3);
+        out[r + 1] = mlpOut(m, c0, c1, c2, c3);
+    }
+    if(r < n) {
+        const float* x = rows + r * kFeatures;
+        __m256 h0 = _mm256_load_ps(m.b1),      h1 = _mm256_load_ps(m.b1 + 8);
+        __m256 h2 = _mm256_load_ps(m.b1 + 16), h3 = _mm256_load_ps(m.b1 + 24);
+        for(std::size_t i=0;i<kFeatures;++i) {
+            const __m256 xi = _mm256_broadcast_ss(x + i);
+            const float* w  = m.w1 + i * EvalModel::kHidden;
+            h0 = _mm256_fmadd_ps(xi, _mm256_load_ps(w),      h0);
+            h1 = _mm256_fmadd_ps(xi, _mm256_load_ps(w + 8),  h1);
+            h2 = _mm256_fmadd_ps(xi, _mm256_load_ps(w + 16), h2);
+            h3 = _mm256_fmadd_ps(xi, _mm256_load_ps(w + 24), h3);
+        }
+        out[r] = mlpOut(m, h0, h1, h2, h3);
+    }
+}
+
+/* linear: 9 FMAs per row, rows must be 32-byte aligned */
+__attribute__((target("avx2,fma")))
+static void linearAvx2(const EvalModel& m, const float* rows, std::size_t n, float* out) {
+    for(std::size_t r=0; r<n; ++r) {
+        const float* x = rows + r * kFeatures;
+        __m256 acc = _mm256_setzero_ps();
+        for(std::size_t i=0;i<kFeatures;i+=8)
+            acc = _mm256_fmadd_ps(_mm256_load_ps(x + i), _mm256_load_ps(m.lin + i), acc);
+        out[r] = sigmoid(hsum(acc) + m.linB);
+    }
+}
+
+static const bool kHasAvx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+
+void EvalModel::evaluate(const float* rows, std::size_t n, float* out) const {
+#ifdef COUP_EVAL_AVX2
+    if(kHasAvx2 && reinterpret_cast<std::uintptr_t>(rows) % 32 == 0) {
+        if(kind_ == Kind::Mlp) mlpAvx2(*this, rows, n, out);
+        else                   linearAvx2(*this, rows, n, out);
+        return;
+    }
+#endif
+    evaluateScalar(rows, n, out);
+}
+
+/* ── persistence ──────────────────────────────────────────── */
+static constexpr char kMagic[8] = {'C','O','U','P','E','V','L','1'};
+
+void EvalModel::save(const std::string& path) const {
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if(!f) throw std::runtime_error("cannot open " + path);
+    const auto k = static_cast<std::uint8_t>(kind_);
+    bool ok = std::fwrite(kMagic, 1, sizeof kMagic, f) == sizeof kMagic
+           && std::fwrite(&k, 1, 1, f) == 1
+           && std::fwrite(w1, sizeof w1, 1, f) == 1 && std::fwrite(b1, sizeof b1, 1, f) == 1
+           && std::fwrite(w2, sizeof w2, 1, f) == 1 && std::fwrite(&b2, sizeof b2, 1, f) == 1
+           && std::fwrite(lin, sizeof lin, 1, f) == 1 && std::fwrite(&linB, sizeof linB, 1, f) == 1;
+    ok = (std::fclose(f) == 0) && ok;
+    if(!ok) throw std::runtime_error("cannot write " + path);
+}
+
+void EvalModel::load(const std::string& path) {
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if(!f) throw std::runtime_error("cannot open " + path);
+    char magic[sizeof kMagic];
+    std::uint8_t k = 0;
+    EvalModel m;
+    const bool ok = std::fread(magic, 1, sizeof magic, f) == sizeof magic
+                 && std::memcmp(magic, kMagic, sizeof kMagic) == 0
+                 && std::fread(&k, 1, 1, f) == 1
+                 && std::fread(m.w1, sizeof m.w1, 1, f) == 1 && std::fread(m.b1, sizeof m.b1, 1, f) == 1
+                 && std::fread(m.w2, sizeof m.w2, 1, f) == 1 && std::fread(&m.b2, sizeof m.b2, 1, f) == 1
+                 && std::fread(m.lin, sizeof m.lin, 1, f) == 1 && std::fread(&m.linB, sizeof m.linB, 1, f) == 1
+                 && k <= static_cast<std::uint8_t>(Kind::Mlp);
+    std::fclose(f);
+    if(!ok) throw std::runtime_error(path + ": not an evaluation model");
+    m.kind_ = static_cast<Kind>(k);
+    *this = m;
+}
+
+/* ── EvalBot ──────────────────────────────────────────────── */
+Game& EvalBot::scratch(const Game& g) {
+    const auto& roster = g.roster();
+    bool same = table_ && roles_.size() == roster.size();
+    for(std::size_t i=0; same && i<roster.size(); ++i) same = roles_[i] == roleOf(*roster[i]);
+    if(!same) {
+        roles_.clear();
+        for(const auto* p : roster) roles_.push_back(roleOf(*p));
+        table_ = std::make_unique<Table>(Table::deal(roles_));
+    }
+    table_->game->load(g.state());
+    return *table_->game;
+}
+
+coup::Action EvalBot::choose(const Game& g, const std::vector<coup::Action>& moves, Rng& rng) {
+    if(moves.size() == 1 || rng.uniform() < epsilon_) return moves[rng.below(moves.size())];
+    if(batch_.capacity() < moves.size()) batch_ = FeatureBatch(moves.size());
+    value_.resize(moves.size());
+
+    /* finished games are scored exactly – the model never sees them */
+    const std::size_t me = g.turnIndex();
+    std::size_t winning = moves.size();
+    batch_.clear();
+    for(std::size_t i=0;i<moves.size();++i) {
+        Game& s = scratch(g);
+        apply(s, moves[i]);
+        if(aliveCount(s) == 1 && s.alive(me)) winning = i;
+        extractFeatures(s.state(), roles_, me, batch_.push());
+    }
+    if(winning < moves.size()) return moves[winning];
+    model_->evaluate(batch_.data(), moves.size(), value_.data());
+    return moves[std::max_element(value_.begin(), value_.end()) - value_.begin()];
+}
+
+bool EvalBot::react(const Game& g, std::size_t seat, Rng& rng) {
+    if(rng.uniform() < epsilon_) return rng.uniform() < 0.5;
+    batch_.clear();
+    Game& s = scratch(g);
+    if(s.pending()) s.commit();                 // letting a proposal through
+    extractFeatures(s.state(), roles_, seat, batch_.push());
+    scratch(g).block({coup::Action::Type::Block, seat, {}});
+    extractFeatures(s.state(), roles_, seat, batch_.push());
+    float v[2];
+    model_->evaluate(batch_.data(), 2, v);
+    return v[1] > v[0];
+}
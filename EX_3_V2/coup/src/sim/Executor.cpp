@@ -0,0 +1,211 @@
+// thelet.shevach@gmail.com
+#include "sim/Executor.hpp"
+#include "sim/MoveGen.hpp"
+
+namespace coup_sim {
+
+namespace {
+constexpr std::size_t   kPerVisit = 64;     // commands per table before moving on
+constexpr std::uint64_t kUnarmed  = 0;      // clock keys are tick*2+1 / tick*2+2
+
+/* Gather when legal, otherwise whatever is legal first (a forced coup) */
+bool defaultMove(const coup::Game& g, coup::Action& out) {
+    std::vector<coup::Action> moves;
+    legalMoves(g, moves);
+    if(moves.empty()) return false;
+    out = moves.front();
+    for(const auto& m : moves)
+        if(m.type == coup::Action::Type::Gather) { out = m; break; }
+    return true;
+}
+} // namespace
+
+TableExecutor::TableExecutor(std::size_t inboxCapacity)
+    : inboxCapacity_(inboxCapacity),
+      ready_(std::make_unique<MpscRing<std::size_t>>(1)),
+      wheel_([this](std::uint64_t id){ expire(static_cast<std::size_t>(id)); })
+{}
+
+TableExecutor::~TableExecutor() { stop(); }
+
+/* each id sits in ready_ at most once, so ready_ never needs more room
+   than there are tables                                                 */
+std::size_t TableExecutor::adopt(Table t) {
+    if(running_) throw std::logic_error("adopt tables before start()");
+    cells_.push_back(std::make_unique<Cell>(std::move(t), inboxCapacity_));
+    if(cells_.size() > ready_->capacity()) {
+        auto bigger = std::make_unique<MpscRing<std::size_t>>(2 * cells_.size());
+        std::size_t id;
+        while(ready_->pop(id)) bigger->push(std::move(id));
+        ready_ = std::move(bigger);
+    }
+    rearm(cells_.size() - 1);
+    return cells_.size() - 1;
+}
+
+/* ── posting ──────────────────────────────────────────────── */
+bool TableExecutor::post(std::size_t id, Command cmd) {
+    Cell& c = *cells_.at(id);
+    if(!c.inbox.push(std::move(cmd))) return false;
+    if(!c.scheduled.exchange(true, std::memory_order_acq_rel)) {
+        ready_->push(std::move(id));
+        wake();
+    }
+    return true;
+}
+
+std::future<void> TableExecutor::perform(std::size_t id, const coup::Action& a) {
+    auto p = std::make_shared<std::promise<void>>();
+    auto fut = p->get_future();
+    const bool ok = post(id, [p, a](coup::Game& g) {
+        try { apply(g, a); p->set_value(); }
+        catch(...) { p->set_exception(std::current_exception()); }
+    });
+    if(!ok) p->set_exception(std::make_exception_ptr(std::runtime_error("table inbox full")));
+    return fut;
+}
+
+/* the executor may be about to sleep: it sets sleeping_ and then looks at
+   ready_, we pushed to ready_ and then look at sleeping_ – the fences make
+   sure at least one side sees the other                                   */
+void TableExecutor::wake() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(sleeping_.load(std::memory_order_relaxed)) {
+        { std::lock_guard<std::mutex> lock(sleepM_); signal_.fetch_add(1, std::memory_order_release); }
+        sleepCv_.notify_one();
+    }
+}
+
+/* ── executing ────────────────────────────────────────────── */
+std::size_t TableExecutor::drain(std::size_t id, std::size_t budget) {
+    Cell& c = *cells_[id];
+    Command cmd;
+    std::size_t done = 0;
+    while(done < budget && c.inbox.pop(cmd)) {
+        try { cmd(*c.table.game); } catch(...) {}    // raw commands report their own errors
+        ++done;
+    }
+    c.executed += done;
+    rearm(id);
+    /* a producer that saw scheduled==true left the id to us; if its mail
+       arrived after the last pop, put the table back in line            */
+    c.scheduled.exchange(false, std::memory_order_acq_rel);
+    if(!c.inbox.empty() && !c.scheduled.exchange(true, std::memory_order_acq_rel))
+        ready_->push(std::move(id));
+    return done;
+}
+
+std::size_t TableExecutor::run(std::size_t budget) {
+    std::size_t done = 0, id;
+    while(done < budget && ready_->pop(id)) done += drain(id, kPerVisit);
+    return done;
+}
+
+void TableExecutor::loop() {
+    using Clock = std::chrono::steady_clock;
+    auto last = Clock::now();                              // wheel time, in whole ticks
+    for(;;) {
+        if(timed()) {
+            const auto ticks = (Clock::now() - last) / timers_.tick;
+            if(ticks > 0) {
+                last += ticks * timers_.tick;
+                wheel_.advance(static_cast<std::uint64_t>(ticks));
+            }
+        }
+        if(run(kPerVisit * 16)) continue;
+        const std::uint32_t seen = signal_.load(std::memory_order_acquire);
+        sleeping_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const bool idle = ready_->empty();
+        if(!idle || !running_.load()) {
+            sleeping_.store(false, std::memory_order_relaxed);
+            if(idle) return;                               // stopped and drained
+            continue;
+        }
+        {
+            std::unique_lock<std::mutex> lock(sleepM_);
+            const auto woken = [&]{ return signal_.load(std::memory_order_acquire) != seen; };
+            if(wheel_.size()) sleepCv_.wait_until(lock, last + timers_.tick, woken);
+            else              sleepCv_.wait(lock, woken);
+        }
+        sleeping_.store(false, std::memory_order_relaxed);
+    }
+}
+
+void TableExecutor::start(std::function<void()> onThread) {
+    if(running_.exchange(true)) return;
+    thread_ = std::thread([this, onThread = std::move(onThread)] {
+        if(onThread) onThread();
+        loop();
+    });
+}
+
+void TableExecutor::stop() {
+    if(!running_.exchange(false)) return;
+    { std::lock_guard<std::mutex> lock(sleepM_); signal_.fetch_add(1, std::memory_order_release); }
+    sleepCv_.notify_one();
+    thread_.join();
+}
+
+std::vector<Table> TableExecutor::release() {
+    if(running_) throw std::logic_error("release tables after stop()");
+    run();                                                 // mail posted while stopped
+    std::vector<Table> out;
+    out.reserve(cells_.size());
+    for(auto& c : cells_) {
+        wheel_.cancel(c->timer);
+        out.push_back(std::move(c->table));
+    }
+    cells_.clear();
+    return out;
+}
+
+/* ── turn clock ───────────────────────────────────────────── */
+void TableExecutor::setTimers(TurnTimers t) {
+    if(running_) throw std::logic_error("set timers before start()");
+    if(t.tick.count() <= 0) throw std::invalid_argument("timer tick must be positive");
+    timers_ = t;
+    for(std::size_t id=0; id<cells_.size(); ++id) {
+        wheel_.cancel(cells_[id]->timer);
+        cells_[id]->timer    = TimingWheel::none;
+        cells_[id]->armedFor = kUnarmed;
+        rearm(id);
+    }
+}
+
+std::size_t TableExecutor::advanceClock(std::chrono::milliseconds elapsed) {
+    return wheel_.advance(static_cast<std::uint64_t>(elapsed / timers_.tick));
+}
+
+/* one timer per table, keyed by (tick, proposal open): commands that do
+   not move the game on – queries, rejected actions, a Bribe – keep it   */
+void TableExecutor::rearm(std::size_t id) {
+    if(!timed()) return;
+    Cell& c = *cells_[id];
+    const coup::Game& g = *c.table.game;
+    const bool open = g.pending() != nullptr;
+    const std::uint64_t key = g.isOver() ? kUnarmed : g.tick() * 2 + (open ? 2 : 1);
+    if(key == c.armedFor) return;
+    wheel_.cancel(c.timer);
+    c.timer    = TimingWheel::none;
+    c.armedFor = key;
+    const auto wait = open ? timers_.reaction : timers_.turn;
+    if(key == kUnarmed || wait.count() <= 0) return;
+    const auto ticks = (wait + timers_.tick - std::chrono::milliseconds(1)) / timers_.tick;
+    c.timer = wheel_.schedule(static_cast<std::uint64_t>(ticks), id);
+}
+
+void TableExecutor::expire(std::size_t id) {
+    Cell& c = *cells_[id];
+    c.timer    = TimingWheel::none;
+    c.armedFor = kUnarmed;
+    coup::Game& g = *c.table.game;
+    try {
+        coup::Action a{};
+        if(g.pending())               { g.commit(); ++timeouts_; }
+        else if(defaultMove(g, a))    { apply(g, a); ++timeouts_; }
+    } catch(...) {}            // a failed commit drops the proposal; the turn timer takes over
+    rearm(id);
+}
+
+} // namespace coup_sim
@@ -0,0 +1,106 @@
+// thelet.shevach@gmail.com
+#include "sim/GameIndex.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <stdexcept>
+
+namespace coup_sim {
+
+using coup::Action;
+
+/* ── keys: per role [winner, seated, did × 9, blocked × 3, targeted × 27],
+      then draw, winnerDid × 9, winnerBlocked × 3 ─────────────── */
+namespace {
+constexpr std::uint32_t kGlobal = kRoleCount * Event::kPerRole;
+
+std::uint32_t roleBase(Role r) { return static_cast<std::uint32_t>(r) * Event::kPerRole; }
+std::uint32_t typeOf  (Action::Type t) { return static_cast<std::uint32_t>(t); }
+
+BlockKind kindOf(Action::Type t) {
+    return t == Action::Type::Tax   ? BlockTax
+         : t == Action::Type::Bribe ? BlockBribe
+         :                            BlockCoup;
+}
+} // namespace
+
+Event Event::winner (Role r) { return {roleBase(r)}; }
+Event Event::seated (Role r) { return {roleBase(r) + 1}; }
+Event Event::did    (Role r, Action::Type t) { return {roleBase(r) + 2 + typeOf(t)}; }
+Event Event::blocked(Role r, BlockKind k)    { return {roleBase(r) + 2 + kTypes + k}; }
+Event Event::targeted(Role r, Action::Type t, unsigned times) {
+    if(times < 1 || times > 3) throw std::invalid_argument("targeted: times must be 1..3");
+    return {roleBase(r) + 2 + kTypes + kBlockKinds + typeOf(t) * 3 + (times - 1)};
+}
+Event Event::draw()                          { return {kGlobal}; }
+Event Event::winnerDid(Action::Type t)       { return {kGlobal + 1 + typeOf(t)}; }
+Event Event::winnerBlocked(BlockKind k)      { return {kGlobal + 1 + kTypes + k}; }
+
+/* ── building ─────────────────────────────────────────────── */
+GameIndex::GameIndex(const ArchiveReader& r) : sets_(Event::kKeys) {
+    r.scan([this](const ArchivedGame& g){ add(g); });
+}
+
+void GameIndex::add(const ArchivedGame& g) {
+    if(g.id > UINT32_MAX) throw std::invalid_argument("game index: ids must fit in 32 bits");
+    const auto id = static_cast<std::uint32_t>(g.id);
+    const std::size_t n = std::min<std::size_t>(g.roles.size(), 16);      // archives seat ≤ 16
+    const bool won = g.winner < n;
+
+    /* one pass folds the moves into per-seat masks and target counts.  A
+       Block answers the open Tax / Bribe / Coup, which – as in the engine –
+       stays open until a block or until its actor starts another turn; a
+       Bribe or a peek leaves the turn with its actor                      */
+    constexpr std::size_t none = 16;
+    std::array<std::uint16_t, 16> did{}, blocked{};
+    std::array<std::array<std::uint8_t, Event::kTypes>, 16> hits{};
+    BlockKind   open      = BlockTax;
+    std::size_t openActor = none, turnGoesOn = none;
+    for(const Action& a : g.actions) {
+        if(a.actor >= n) continue;
+        const unsigned t = typeOf(a.type);
+        did[a.actor] |= static_cast<std::uint16_t>(1u << t);
+        if(a.type == Action::Type::Block) {
+            if(openActor != none) blocked[a.actor] |= static_cast<std::uint16_t>(1u << open);
+            openActor = none;
+            continue;
+        }
+        if(a.actor == openActor && a.actor != turnGoesOn) openActor = none;   // a new turn of its actor
+        if(a.type == Action::Type::Tax || a.type == Action::Type::Bribe || a.type == Action::Type::Coup) {
+            open      = kindOf(a.type);
+            openActor = a.actor;
+        }
+        turnGoesOn = a.type == Action::Type::Bribe || a.type == Action::Type::SpyPeek ? a.actor : none;
+        if(a.target && *a.target < n) {
+            auto& c = hits[*a.target][t];
+            c += c < 3;
+        }
+    }
+
+    /* events repeat across seats: collect them, then add the id once each */
+    std::bitset<Event::kKeys> seen;
+    auto mark = [&](Event e){ seen.set(e.key); };
+    if(won) mark(Event::winner(g.roles[g.winner]));
+    else    mark(Event::draw());
+    for(std::size_t s=0; s<n; ++s) {
+        const Role role = g.roles[s];
+        mark(Event::seated(role));
+        for(std::uint32_t t=0; t<Event::kTypes; ++t) {
+            if(did[s] >> t & 1) {
+                mark(Event::did(role, static_cast<Action::Type>(t)));
+                if(won && s == g.winner) mark(Event::winnerDid(static_cast<Action::Type>(t)));
+            }
+            for(unsigned k=1; k<=hits[s][t]; ++k) mark(Event::targeted(role, static_cast<Action::Type>(t), k));
+        }
+        for(unsigned k=0; k<kBlockKinds; ++k) {
+            if(!(blocked[s] >> k & 1)) continue;
+            mark(Event::blocked(role, static_cast<BlockKind>(k)));
+            if(won && s == g.winner) mark(Event::winnerBlocked(static_cast<BlockKind>(k)));
+        }
+    }
+    all_.add(id);
+    for(std::uint32_t k=0; k<Event::kKeys; ++k) if(seen[k]) sets_[k].add(id);
+}
+
+} // namespace coup_sim
@@ -0,0 +1,240 @@
+// thelet.shevach@gmail.com
+#include "sim/Ismcts.hpp"
+#include "sim/MoveGen.hpp"
+#include "core/Player.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+using namespace coup_sim;
+using coup::Action;
+using coup::ActionCode;
+using coup::Game;
+
+namespace {
+
+struct Node {
+    ActionCode                 move{};       // move.actor() played it
+    std::vector<std::uint32_t> children;
+    double                     reward{0};    // summed, from the mover's view
+    std::uint32_t              visits{0};
+    std::uint32_t              avail{0};     // samples in which move was legal
+};
+
+/* the open proposal's (random) reactions from `from` on, then the commit */
+void settle(Game& g, std::size_t from, Rng& rng) {
+    const std::size_t n     = g.roster().size();
+    const std::size_t actor = g.pending()->actor;
+    for(std::size_t s=from; s!=actor; s=(s+1)%n)
+        if(canBlock(g,s) && rng.uniform() < 0.5) { g.block({Action::Type::Block, s, {}}); return; }
+    g.commit();
+}
+
+/* one move plus the opponents' reaction to it, proposed as the simulator does */
+void step(Game& g, ActionCode m, Rng& rng) {
+    if(!blockable(m.type())) { apply(g, m); return; }
+    g.propose(m.decode());
+    settle(g, (m.actor() + 1) % g.roster().size(), rng);
+}
+
+/* random moves until `depth` runs out or one seat is left */
+void rollout(Game& g, std::size_t depth, Rng& rng, std::vector<ActionCode>& moves) {
+    for(std::size_t d=0; d<depth && aliveCount(g) > 1; ++d) {
+        moves.clear();
+        legalMoves(g, moves);
+        if(moves.empty()) break;
+        step(g, moves[rng.below(moves.size())], rng);
+    }
+}
+
+/* 1 for the winner; unfinished games share 1 by coins among the living */
+void score(const Game& g, std::vector<double>& out) {
+    const std::size_t n = g.roster().size();
+    out.assign(n, 0.0);
+    double total = 0;
+    const auto living = g.living();
+    for(auto it=living.begin(); it!=living.end(); ++it) {
+        out[it.seat()] = g.coins(it.seat()) + 3.0;
+        total += out[it.seat()];
+    }
+    for(auto& v : out) v /= total;
+}
+
+/* the same share, but from the model's win probability of every living seat */
+void score(const Game& g, const std::vector<Role>& roles, const EvalModel& m,
+           FeatureBatch& batch, float* value, std::vector<double>& out)
+{
+    const std::size_t n = g.roster().size();
+    if(aliveCount(g) < 2) { score(g, out); return; }
+    const Game::State s = g.state();
+    batch.clear();
+    for(std::size_t i=0;i<n;++i) extractFeatures(s, roles, i, batch.push());
+    m.evaluate(batch.data(), n, value);
+    out.assign(n, 0.0);
+    double total = 0;
+    for(std::size_t i=0;i<n;++i)
+        if(g.alive(i)) { out[i] = value[i] + 1e-6; total += out[i]; }
+    for(auto& v : out) v /= total;
+}
+
+struct Tree {
+    std::vector<Node> nodes;
+
+    std::uint32_t find(std::uint32_t at, ActionCode m) const {
+        for(auto c : nodes[at].children) if(nodes[c].move == m) return c;
+        return 0;
+    }
+};
+
+void searchThread(const Observation& obs, const IsmctsConfig& cfg, std::uint64_t seed,
+                  std::chrono::steady_clock::time_point deadline, Tree& tree)
+{
+    Rng   rng(seed);
+    Table t = Table::deal(obs.roles);
+    Game& g = *t.game;
+
+    tree.nodes.assign(1, Node{});
+    std::vector<ActionCode>    moves, untried;
+    std::vector<std::uint32_t> path, live;
+    std::vector<double>        reward;
+    FeatureBatch               batch(obs.roles.size());
+    std::vector<float>         value(obs.roles.size());
+
+    for(std::size_t it=0; it<cfg.iterations; ++it) {
+        if((it & 31) == 0 && std::chrono::steady_clock::now() >= deadline) break;
+
+        g.load(determinize(obs, rng));
+        path.assign(1, 0);
+        std::uint32_t at = 0;
+
+        /* selection / expansion; at the root too the moves come from the
+           sample, so an Arrest is tried only where the drawn coins allow it */
+        while(aliveCount(g) > 1) {
+            moves.clear();
+            legalMoves(g, moves);
+            if(moves.empty()) break;
+
+            untried.clear();
+            live.clear();
+            for(ActionCode m : moves) {
+                if(std::uint32_t c = tree.find(at, m)) { ++tree.nodes[c].avail; live.push_back(c); }
+                else untried.push_back(m);
+            }
+            if(!untried.empty()) {
+                const ActionCode m = untried[rng.below(untried.size())];
+                Node child;
+                child.move  = m;
+                child.avail = 1;
+                tree.nodes.push_back(std::move(child));
+                const auto id = static_cast<std::uint32_t>(tree.nodes.size() - 1);
+                tree.nodes[at].children.push_back(id);
+                path.push_back(id);
+                step(g, m, rng);
+                break;
+            }
+
+            std::uint32_t best = live[0];
+            double bestUcb = -1;
+            for(auto c : live) {
+                const Node& nd = tree.nodes[c];
+                const double ucb = nd.reward / nd.visits
+                                 + cfg.exploration * std::sqrt(std::log(double(nd.avail)) / nd.visits);
+                if(ucb > bestUcb) { bestUcb = ucb; best = c; }
+            }
+            step(g, tree.nodes[best].move, rng);
+            path.push_back(best);
+            at = best;
+        }
+
+        rollout(g, cfg.rolloutDepth, rng, moves);
+
+        /* backpropagation */
+        if(cfg.eval) score(g, obs.roles, *cfg.eval, batch, value.data(), reward);
+        else         score(g, reward);
+        for(auto id : path) {
+            Node& nd = tree.nodes[id];
+            ++nd.visits;
+            if(id) nd.reward += reward[nd.move.actor()];
+        }
+    }
+}
+
+} // namespace
+
+Action coup_sim::ismctsSearch(const Observation& obs, const std::vector<Action>& rootMoves,
+                              const IsmctsConfig& cfg, std::uint64_t seed)
+{
+    if(rootMoves.size() == 1) return rootMoves[0];
+
+    const auto deadline = std::chrono::steady_clock::now()
+                        + std::chrono::microseconds(static_cast<long long>(cfg.budgetMs * 1000));
+    const unsigned nThreads = std::max(1u, cfg.threads);
+    std::vector<Tree> trees(nThreads);
+    std::vector<ActionCode> rootCodes(rootMoves.begin(), rootMoves.end());
+
+    std::vector<std::thread> pool;
+    for(unsigned w=1; w<nThreads; ++w)
+        pool.emplace_back(searchThread, std::cref(obs), std::cref(cfg),
+                          seed + w * 0x9E3779B97F4A7C15ull, deadline, std::ref(trees[w]));
+    searchThread(obs, cfg, seed, deadline, trees[0]);
+    for(auto& t : pool) t.join();
+
+    /* merge at the root: summed visits per move the table actually allows;
+       the search itself never saw that list                               */
+    std::vector<std::uint64_t> visits(rootMoves.size(), 0);
+    for(const Tree& tr : trees)
+        for(auto c : tr.nodes[0].children) {
+            const Node& nd = tr.nodes[c];
+            auto it = std::find(rootCodes.begin(), rootCodes.end(), nd.move);
+            if(it != rootCodes.end()) visits[it - rootCodes.begin()] += nd.visits;
+        }
+    return rootMoves[std::max_element(visits.begin(), visits.end()) - visits.begin()];
+}
+
+bool coup_sim::ismctsReact(const Observation& obs, const IsmctsConfig& cfg, std::uint64_t seed) {
+    const auto deadline = std::chrono::steady_clock::now()
+                        + std::chrono::microseconds(static_cast<long long>(cfg.budgetMs * 1000));
+    const std::size_t me = obs.seat, n = obs.roles.size();
+    Rng   rng(seed);
+    Table t = Table::deal(obs.roles);
+    Game& g = *t.game;
+    std::vector<ActionCode> moves;
+    std::vector<double>     reward;
+    FeatureBatch            batch(n);
+    std::vector<float>      value(n);
+
+    /* arm 0 lets the action stand, arm 1 blocks it */
+    double        sum[2]   = {0, 0};
+    std::uint64_t pulls[2] = {0, 0};
+    for(std::size_t it=0; it<cfg.iterations; ++it) {
+        if((it & 31) == 0 && std::chrono::steady_clock::now() >= deadline) break;
+        g.load(determinize(obs, rng));
+        if(!canBlock(g, me)) break;                    // nothing this seat may answer
+
+        int arm = pulls[0] ? pulls[1] ? -1 : 1 : 0;
+        if(arm < 0) {
+            const double total = std::log(double(pulls[0] + pulls[1]));
+            double ucb[2];
+            for(int k=0;k<2;++k) ucb[k] = sum[k] / pulls[k] + cfg.exploration * std::sqrt(total / pulls[k]);
+            arm = ucb[1] > ucb[0];
+        }
+        if(arm)              g.block({Action::Type::Block, me, {}});
+        else if(g.pending()) settle(g, (me + 1) % n, rng);   // later seats may still block
+        rollout(g, cfg.rolloutDepth, rng, moves);
+
+        if(cfg.eval) score(g, obs.roles, *cfg.eval, batch, value.data(), reward);
+        else         score(g, reward);
+        sum[arm] += reward[me];
+        ++pulls[arm];
+    }
+    return pulls[0] && pulls[1] && sum[1] / pulls[1] > sum[0] / pulls[0];
+}
+
+Action IsmctsBot::choose(const Game& g, const std::vector<Action>& moves, Rng& rng) {
+    return ismctsSearch(observe(g, g.turnIndex()), moves, cfg_, rng.next());
+}
+
+bool IsmctsBot::react(const Game& g, std::size_t seat, Rng& rng) {
+    return ismctsReact(observe(g, seat), cfg_, rng.next());
+}
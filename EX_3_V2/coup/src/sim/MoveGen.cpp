@@ -0,0 +1,107 @@
+// thelet.shevach@gmail.com
+#include "sim/MoveGen.hpp"
+#include "sim/Table.hpp"
+#include "core/Player.hpp"
+#include <type_traits>
+
+using namespace coup_sim;
+using coup::Action;
+using coup::ActionCode;
+using coup::Game;
+using coup::Player;
+
+namespace {
+
+/* one generator for both move-list types: out.push_back(Action) or its code */
+template<class T> void put(std::vector<T>& out, const Action& a) {
+    if constexpr (std::is_same_v<T, Action>) out.push_back(a);
+    else                                     out.push_back(ActionCode(a));
+}
+
+/* ── turn holder's moves ──────────────────────────────────── */
+template<class T> void genMoves(const Game& g, std::vector<T>& out) {
+    const std::size_t me = g.turnIndex();
+    const auto& roster   = g.roster();
+    if(!g.alive(me) || g.isOver() || g.pending()) return;   // eliminated, over, or a proposal is open
+
+    const Player& p   = *roster[me];
+    const int   coins = g.coins(me);
+    const bool  sanctioned = g.sanctioned(me);
+    const std::size_t lastArrested = g.lastArrested(me);
+
+    const auto living = g.living();
+    auto forEachTarget = [&](auto&& f){
+        for(auto it=living.begin(); it!=living.end(); ++it)
+            if(it.seat()!=me) f(it.seat());
+    };
+
+    if(coins >= 7)
+        forEachTarget([&](std::size_t t){ put(out, {Action::Type::Coup, me, t}); });
+    if(coins >= 10) return;                               // forced coup
+
+    if(!sanctioned) {
+        put(out, {Action::Type::Gather, me, {}});
+        put(out, {Action::Type::Tax,    me, {}});
+    }
+    if(coins >= 4) put(out, {Action::Type::Bribe, me, {}});
+    if(coins >= 3 && roleOf(p) == Role::Baron && !sanctioned)
+        put(out, {Action::Type::Invest, me, {}});
+
+    forEachTarget([&](std::size_t t){
+        const Player& tgt = *roster[t];
+        const Role    r   = roleOf(tgt);
+
+        if(lastArrested != t) {
+            const int loses = r==Role::Merchant ? 2 : r==Role::General ? 0 : 1;
+            if(g.coins(t) >= loses) put(out, {Action::Type::Arrest, me, t});
+        }
+        if(coins >= (r==Role::Judge ? 4 : 3))
+            put(out, {Action::Type::Sanction, me, t});
+    });
+}
+
+template<class T> void genBlocks(const Game& g, std::vector<T>& out) {
+    for(std::size_t s=0;s<g.roster().size();++s)
+        if(canBlock(g,s)) put(out, {Action::Type::Block, s, {}});
+}
+
+} // namespace
+
+void coup_sim::legalMoves (const Game& g, std::vector<Action>& out)     { genMoves(g, out); }
+void coup_sim::legalMoves (const Game& g, std::vector<ActionCode>& out) { genMoves(g, out); }
+void coup_sim::legalBlocks(const Game& g, std::vector<Action>& out)     { genBlocks(g, out); }
+void coup_sim::legalBlocks(const Game& g, std::vector<ActionCode>& out) { genBlocks(g, out); }
+
+/* ── reactions ────────────────────────────────────────────── */
+bool coup_sim::canBlock(const Game& g, std::size_t seat) {
+    const Action* src = g.blockable();
+    if(!src || src->actor == seat) return false;
+    if(!g.alive(seat) && !(src->type == Action::Type::Coup && src->target == seat)) return false;
+
+    const Player& blocker = *g.roster()[seat];
+    const Player& actor   = *g.roster()[src->actor];
+    switch(src->type) {
+    case Action::Type::Tax:                          // undoing an applied Tax takes the coins back
+        return roleOf(blocker) == Role::Governor
+            && (g.pending() || g.coins(src->actor) >= (roleOf(actor) == Role::Governor ? 3 : 2));
+    case Action::Type::Bribe:
+        return roleOf(blocker) == Role::Judge;
+    case Action::Type::Coup:                         // a blocked proposal still costs the couper 7
+        return roleOf(blocker) == Role::General && g.coins(seat) >= 5
+            && (!g.pending() || g.coins(src->actor) >= 7);
+    default:
+        return false;
+    }
+}
+
+void coup_sim::apply(Game& g, const Action& a) {
+    if(a.type == Action::Type::Block) g.block(a);
+    else                              g.perform(a);
+}
+
+void coup_sim::apply(Game& g, ActionCode c) {
+    if(c.type() == Action::Type::Block) g.block(c);
+    else                                g.perform(c);
+}
+
+std::size_t coup_sim::aliveCount(const Game& g) { return g.aliveCount(); }
@@ -0,0 +1,55 @@
+// thelet.shevach@gmail.com
+#include "sim/Observation.hpp"
+#include <algorithm>
+
+using namespace coup_sim;
+using coup::Game;
+
+Observation coup_sim::observe(const Game& g, std::size_t seat) {
+    Observation o;
+    o.seat  = seat;
+    o.state = g.state();
+    const std::size_t n = o.state.seats.size();
+    o.peeked.assign(n, kHiddenCoins);
+    o.peekAge.assign(n, 0);
+    for(std::size_t i=0;i<n;++i) {
+        o.roles.push_back(roleOf(*g.roster()[i]));
+        if(i == seat) continue;
+        o.state.seats[i].coins = kHiddenCoins;
+        if(const Game::Peek* p = g.lastPeek(seat, i)) {
+            o.peeked[i]  = p->coins;
+            o.peekAge[i] = g.tick() - p->tick;
+        }
+    }
+    return o;
+}
+
+Game::State coup_sim::determinize(const Observation& o, Rng& rng) {
+    Game::State s = o.state;
+    std::size_t alive = 0;
+    for(const auto& seat : s.seats) alive += seat.alive;
+    alive = std::max<std::size_t>(alive, 1);
+
+    for(std::size_t i=0;i<s.seats.size();++i) {
+        if(s.seats[i].coins != kHiddenCoins) continue;
+        int lo = 0, hi;
+        if(o.peeked[i] != kHiddenCoins) {
+            const int turns = static_cast<int>((o.peekAge[i] + alive - 1) / alive);
+            lo = std::max(0, o.peeked[i] - 2*turns);              // arrests, spending
+            hi = o.peeked[i] + 3*turns;                           // tax, invest
+        } else {
+            hi = 1 + 2 * static_cast<int>(s.tick / alive);
+        }
+        hi = std::min(hi, 9);
+        lo = std::min(lo, hi);
+        /* an open proposal shows its actor can pay for it */
+        if(s.pending && s.pending->actor == i) {
+            const int cost = s.pending->type == coup::Action::Type::Coup  ? 7
+                           : s.pending->type == coup::Action::Type::Bribe ? 4 : 0;
+            lo = std::max(lo, cost);
+            hi = std::max(hi, lo);
+        }
+        s.seats[i].coins = lo + static_cast<int>(rng.below(static_cast<std::size_t>(hi - lo + 1)));
+    }
+    return s;
+}
@@ -0,0 +1,172 @@
+// thelet.shevach@gmail.com
+#include "sim/Perft.hpp"
+#include "sim/MoveGen.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+namespace coup_sim {
+
+using coup::Action;
+using coup::ActionCode;
+using coup::Game;
+
+namespace {
+
+/* ── state key ────────────────────────────────────────────── */
+std::uint64_t mix(std::uint64_t h, std::uint64_t v) {
+    h ^= v + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+    return h * 0xFF51AFD7ED558CCDull;
+}
+
+std::uint64_t keyOf(const Game& g) {
+    const Game::State s = g.state();
+    std::uint64_t h = mix(0, s.turn);
+    for(const auto& seat : s.seats) {
+        /* only "running for k more ticks", "ran out" and "none" matter */
+        const std::uint64_t sanction = !seat.sanctionedUntil          ? 0
+                                     : seat.sanctionedUntil > s.tick ? seat.sanctionedUntil - s.tick + 1
+                                     :                                  1;
+        h = mix(h, static_cast<std::uint64_t>(seat.coins));
+        h = mix(h, seat.lastArrested);
+        h = mix(h, sanction << 1 | seat.alive);
+    }
+    if(s.blockable) h = mix(h, std::uint64_t{ActionCode(*s.blockable).bits()} << 32 | s.blockableExpires);
+    return h;
+}
+
+/* always-replace table of (key, remaining depth) → leaf count */
+class Transpositions {
+public:
+    explicit Transpositions(std::size_t mb) {
+        std::size_t n = 1;
+        while(n * 2 * sizeof(Entry) <= mb << 20) n *= 2;
+        slots_.resize(n);
+    }
+    bool find(std::uint64_t key, unsigned depth, std::uint64_t& count) const {
+        const Entry& e = slots_[(key ^ depth) & (slots_.size() - 1)];
+        if(e.key != key || e.depth != depth) return false;
+        count = e.count;
+        return true;
+    }
+    void store(std::uint64_t key, unsigned depth, std::uint64_t count) {
+        slots_[(key ^ depth) & (slots_.size() - 1)] = {key, count, depth};
+    }
+private:
+    struct Entry { std::uint64_t key{0}, count{0}; unsigned depth{0}; };
+    std::vector<Entry> slots_;
+};
+
+/* ── one thread's walk ────────────────────────────────────── */
+struct Walker {
+    Game&                                 g;
+    Transpositions*                       tt;
+    std::vector<std::vector<ActionCode>>  lists;     // per ply, reused
+    std::vector<std::uint64_t>            leaves;
+    std::uint64_t                         nodes{0};
+
+    Walker(Game& game, unsigned depth, Transpositions* t)
+        : g(game), tt(t), lists(depth + 1), leaves(depth, 0) {}
+
+    const std::vector<ActionCode>& generate(unsigned ply) {
+        auto& out = lists[ply];
+        out.clear();
+        legalMoves (g, out);
+        legalBlocks(g, out);
+        nodes += out.size();
+        return out;
+    }
+
+    /* every depth at once: the position at `ply` has `left` plies below it */
+    void walk(unsigned ply, unsigned left) {
+        const auto& moves = generate(ply);
+        leaves[ply] += moves.size();
+        if(left == 1) return;
+        for(std::size_t i=0;i<lists[ply].size();++i) {
+            const auto u = g.make(lists[ply][i].decode());
+            walk(ply + 1, left - 1);
+            g.unmake(u);
+        }
+    }
+
+    /* sequences of exactly `left` more moves, through the table */
+    std::uint64_t count(unsigned ply, unsigned left) {
+        const std::uint64_t key = keyOf(g);
+        std::uint64_t n = 0;
+        if(tt->find(key, left, n)) return n;
+        const auto& moves = generate(ply);
+        if(left == 1) n = moves.size();
+        else
+            for(std::size_t i=0;i<lists[ply].size();++i) {
+                const auto u = g.make(lists[ply][i].decode());
+                n += count(ply + 1, left - 1);
+                g.unmake(u);
+            }
+        tt->store(key, left, n);
+        return n;
+    }
+};
+
+} // namespace
+
+PerftResult perft(const PerftConfig& cfg) {
+    if(cfg.roles.size() < 2 || cfg.roles.size() >= ActionCode::kMaxSeats)
+        throw std::invalid_argument("perft: need 2..62 seats");
+    if(!cfg.coins.empty() && cfg.coins.size() != cfg.roles.size())
+        throw std::invalid_argument("perft: one coin count per seat");
+    if(cfg.depth == 0) throw std::invalid_argument("perft: depth must be at least 1");
+
+    Table root = Table::deal(cfg.roles);
+    if(!cfg.coins.empty()) {
+        Game::State s = root.game->state();
+        for(std::size_t i=0;i<s.seats.size();++i) s.seats[i].coins = cfg.coins[i];
+        root.game->load(s);
+    }
+
+    std::vector<ActionCode> first;
+    legalMoves (*root.game, first);
+    legalBlocks(*root.game, first);
+
+    PerftResult res;
+    res.leaves.assign(cfg.depth, 0);
+    res.leaves[0] = first.size();
+    res.nodes     = first.size();
+    const auto t0 = std::chrono::steady_clock::now();
+
+    /* thread w takes root moves w, w+T, … on its own copy of the table */
+    const unsigned nThreads = std::max(1u, std::min<unsigned>(cfg.threads, static_cast<unsigned>(first.size())));
+    std::vector<PerftResult> part(nThreads);
+    auto worker = [&](unsigned w) {
+        Table t = root.copy();
+        std::unique_ptr<Transpositions> tt;
+        if(cfg.hashMb) tt = std::make_unique<Transpositions>(cfg.hashMb);
+        Walker walker(*t.game, cfg.depth, tt.get());
+        PerftResult& out = part[w];
+        out.leaves.assign(cfg.depth, 0);
+        for(std::size_t i=w; i<first.size(); i+=nThreads) {
+            const auto u = t.game->make(first[i].decode());
+            if(cfg.depth > 1 && !tt) walker.walk(1, cfg.depth - 1);
+            for(unsigned d=2; tt && d<=cfg.depth; ++d) out.leaves[d-1] += walker.count(1, d - 1);
+            t.game->unmake(u);
+        }
+        if(!tt) for(unsigned d=1; d<cfg.depth; ++d) out.leaves[d] = walker.leaves[d];
+        out.nodes = walker.nodes;
+    };
+    if(cfg.depth > 1) {
+        std::vector<std::thread> pool;
+        for(unsigned w=1; w<nThreads; ++w) pool.emplace_back(worker, w);
+        worker(0);
+        for(auto& t : pool) t.join();
+    }
+    for(const PerftResult& p : part) {
+        for(std::size_t d=1; d<p.leaves.size(); ++d) res.leaves[d] += p.leaves[d];
+        res.nodes += p.nodes;
+    }
+    res.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return res;
+}
+
+} // namespace coup_sim
@@ -0,0 +1,192 @@
+// thelet.shevach@gmail.com
+#include "sim/Rating.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <numbers>
+#include <stdexcept>
+#include <thread>
+
+using namespace coup_sim;
+
+double Ratings::conservative(std::size_t i) const {
+    return mu[i] - 3.0 * std::sqrt(sigma2[i]);
+}
+
+/* ── setup ────────────────────────────────────────────────── */
+static Ratings initial(std::size_t n, const RatingConfig& c) {
+    Ratings r;
+    const bool elo = c.model == RatingModel::Elo;
+    r.mu.assign(n, elo ? c.eloStart : c.mu0);
+    r.sigma2.assign(n, elo ? 0.0 : c.sigma0 * c.sigma0);
+    r.games.assign(n, 0);
+    return r;
+}
+
+RatingEngine::RatingEngine(std::size_t nBots, const RatingConfig& cfg)
+    : cfg_(cfg), bots_(initial(nBots, cfg)), roles_(initial(kRoleCount, cfg))
+{}
+
+void RatingEngine::reset(Deltas& d, std::size_t n) const {
+    d.a.assign(n, 0.0);
+    d.b.assign(n, 0.0);
+    d.games.assign(n, 0);
+}
+
+static constexpr double kEloQ = std::numbers::ln10 / 400.0;   // logistic scale
+
+/* ── one game → statistics against frozen ratings ─────────── */
+void RatingEngine::scoreGame(const GameRecord& g, const Ratings& r, bool byRole, Deltas& d) const {
+    auto entity = [&](std::size_t seat) -> std::size_t {
+        return byRole ? static_cast<std::size_t>(g.role(seat)) : g.bot(seat);
+    };
+    const std::size_t n = std::min<std::size_t>(g.players, kMaxRecordSeats);
+    for(std::size_t s=0;s<n;++s) ++d.games[entity(s)];
+    if(g.winnerSeat == kNoSeat || n < 2) return;
+
+    const std::size_t w = entity(g.winnerSeat);
+    const double      weight = 1.0 / double(n-1);          // one game, n-1 pairs
+    for(std::size_t s=0;s<n;++s) {
+        const std::size_t l = entity(s);
+        if(s == g.winnerSeat || l == w) continue;
+
+        if(cfg_.model == RatingModel::Elo) {
+            const double expect = 1.0 / (1.0 + std::exp(kEloQ * (r.mu[l] - r.mu[w])));
+            const double grad   = weight * kEloQ * (1.0 - expect);
+            const double curv   = weight * kEloQ * kEloQ * expect * (1.0 - expect);
+            d.a[w] += grad;  d.b[w] += curv;
+            d.a[l] -= grad;  d.b[l] += curv;
+        } else {
+            const double tau2 = cfg_.tau * cfg_.tau;
+            const double s2w  = r.sigma2[w] + tau2;
+            const double s2l  = r.sigma2[l] + tau2;
+            const double c2   = 2.0 * cfg_.beta * cfg_.beta + s2w + s2l;
+            const double c    = std::sqrt(c2);
+            const double t    = (r.mu[w] - r.mu[l]) / c;
+            const double cdf  = 0.5 * std::erfc(-t / std::numbers::sqrt2);
+            const double pdf  = std::exp(-0.5 * t * t) / std::sqrt(2.0 * std::numbers::pi);
+            const double v    = cdf > 1e-12 ? pdf / cdf : -t;          // asymptote
+            const double wv   = v * (v + t);
+
+            /* posterior of one side → the message that produced it */
+            auto message = [&](std::size_t e, double s2, double dir) {
+                const double post2  = s2 * std::max(1e-6, 1.0 - s2 / c2 * wv);
+                const double postMu = r.mu[e] + dir * s2 / c * v;
+                d.b[e] += weight * (1.0/post2 - 1.0/s2);
+                d.a[e] += weight * (postMu/post2 - r.mu[e]/s2);
+            };
+            message(w, s2w, +1.0);
+            message(l, s2l, -1.0);
+        }
+    }
+}
+
+void RatingEngine::apply(Ratings& r, const Deltas& d) const {
+    for(std::size_t i=0;i<r.size();++i) {
+        r.games[i] += d.games[i];
+        if(!d.games[i]) continue;
+        if(cfg_.model == RatingModel::Elo) {
+            r.mu[i] += d.a[i] / (d.b[i] + kEloQ / cfg_.eloK);   // K = q / damping
+        } else {
+            const double prior2 = r.sigma2[i] + cfg_.tau * cfg_.tau;
+            const double pi     = 1.0/prior2 + d.b[i];
+            r.mu[i]     = (r.mu[i]/prior2 + d.a[i]) / pi;
+            r.sigma2[i] = 1.0 / pi;
+        }
+    }
+}
+
+/* ── batched, parallel update ─────────────────────────────── */
+void RatingEngine::update(const std::vector<GameRecord>& batch) {
+    if(batch.empty()) return;
+    /* scoreGame indexes by these: refuse the batch before any thread starts */
+    for(const GameRecord& g : batch) {
+        if(g.players > kMaxRecordSeats) continue;                        // skipped below
+        if(g.winnerSeat != kNoSeat && g.winnerSeat >= g.players)
+            throw std::invalid_argument("rating: winner seat out of range");
+        for(std::size_t s=0;s<g.players;++s)
+            if(static_cast<std::size_t>(g.role(s)) >= kRoleCount || g.bot(s) >= bots_.size())
+                throw std::invalid_argument("rating: role or bot out of range");
+    }
+    const std::size_t nThreads = std::clamp<std::size_t>(cfg_.threads, 1, batch.size());
+
+    std::vector<Deltas> botD(nThreads), roleD(nThreads);
+    auto worker = [&](std::size_t w) {
+        reset(botD[w],  bots_.size());
+        reset(roleD[w], roles_.size());
+        const std::size_t lo = batch.size() * w / nThreads;
+        const std::size_t hi = batch.size() * (w+1) / nThreads;
+        for(std::size_t i=lo;i<hi;++i) {
+            if(batch[i].players > kMaxRecordSeats) continue;
+            scoreGame(batch[i], bots_,  false, botD[w]);
+            scoreGame(batch[i], roles_, true,  roleD[w]);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for(std::size_t w=1; w<nThreads; ++w) pool.emplace_back(worker, w);
+    worker(0);
+    for(auto& t : pool) t.join();
+
+    /* fold workers 1.. into worker 0, then apply once */
+    for(std::size_t w=1; w<nThreads; ++w)
+        for(auto [into, from] : {std::pair{&botD[0], &botD[w]}, std::pair{&roleD[0], &roleD[w]}})
+            for(std::size_t i=0;i<into->a.size();++i) {
+                into->a[i]     += from->a[i];
+                into->b[i]     += from->b[i];
+                into->games[i] += from->games[i];
+            }
+    apply(bots_,  botD[0]);
+    apply(roles_, roleD[0]);
+    seen_ += batch.size();
+}
+
+/* ── checkpoints ──────────────────────────────────────────── */
+static constexpr char kMagic[8] = {'C','O','U','P','R','A','T','1'};
+
+void RatingEngine::saveCheckpoint(const std::string& path) const {
+    const std::string tmp = path + ".tmp";
+    std::FILE* f = std::fopen(tmp.c_str(), "wb");
+    if(!f) throw std::runtime_error("cannot open " + tmp);
+
+    const auto model = static_cast<std::uint8_t>(cfg_.model);
+    const std::uint64_t nBots = bots_.size();
+    bool ok = std::fwrite(kMagic, 1, sizeof kMagic, f) == sizeof kMagic
+           && std::fwrite(&model, 1, 1, f) == 1
+           && std::fwrite(&seen_, sizeof seen_, 1, f) == 1
+           && std::fwrite(&nBots, sizeof nBots, 1, f) == 1;
+    for(const Ratings* r : {&bots_, &roles_})
+        ok = ok && std::fwrite(r->mu.data(),     sizeof(double), r->size(), f) == r->size()
+                && std::fwrite(r->sigma2.data(), sizeof(double), r->size(), f) == r->size()
+                && std::fwrite(r->games.data(),  sizeof(std::uint64_t), r->size(), f) == r->size();
+    ok = (std::fclose(f) == 0) && ok;
+    if(!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("cannot write checkpoint " + path);
+    }
+}
+
+void RatingEngine::loadCheckpoint(const std::string& path) {
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if(!f) throw std::runtime_error("cannot open " + path);
+
+    char magic[sizeof kMagic];
+    std::uint8_t  model = 0;
+    std::uint64_t seen = 0, nBots = 0;
+    bool ok = std::fread(magic, 1, sizeof magic, f) == sizeof magic
+           && std::memcmp(magic, kMagic, sizeof kMagic) == 0
+           && std::fread(&model, 1, 1, f) == 1
+           && std::fread(&seen, sizeof seen, 1, f) == 1
+           && std::fread(&nBots, sizeof nBots, 1, f) == 1
+           && model == static_cast<std::uint8_t>(cfg_.model)
+           && nBots == bots_.size();
+    Ratings b = bots_, r = roles_;
+    for(Ratings* x : {&b, &r})
+        ok = ok && std::fread(x->mu.data(),     sizeof(double), x->size(), f) == x->size()
+                && std::fread(x->sigma2.data(), sizeof(double), x->size(), f) == x->size()
+                && std::fread(x->games.data(),  sizeof(std::uint64_t), x->size(), f) == x->size();
+    std::fclose(f);
+    if(!ok) throw std::runtime_error(path + ": not a checkpoint for this model / bot count");
+    bots_ = std::move(b);  roles_ = std::move(r);  seen_ = seen;
+}
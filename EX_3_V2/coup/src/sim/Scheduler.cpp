@@ -0,0 +1,174 @@
+// thelet.shevach@gmail.com
+#include "sim/Scheduler.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <pthread.h>
+#include <sched.h>
+
+namespace coup_sim {
+
+namespace {
+constexpr std::size_t kUnplaced = static_cast<std::size_t>(-1);
+
+/* CPUs this process may run on (taskset / cgroup aware) */
+std::vector<int> usableCpus() {
+    std::vector<int> out;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if(sched_getaffinity(0, sizeof set, &set) == 0)
+        for(int c=0;c<CPU_SETSIZE;++c) if(CPU_ISSET(c, &set)) out.push_back(c);
+    if(out.empty()) out.push_back(0);
+    return out;
+}
+} // namespace
+
+Scheduler::Scheduler(SchedulerConfig cfg) : cfg_(cfg), cpus_(usableCpus()) {
+    const unsigned n = cfg_.workers ? cfg_.workers : static_cast<unsigned>(cpus_.size());
+    for(unsigned w=0; w<n; ++w) workers_.push_back(std::make_unique<TableExecutor>(cfg_.inboxCapacity));
+    pending_.resize(n);
+}
+
+Scheduler::~Scheduler() { stop(); }
+
+std::size_t Scheduler::add(std::function<Table()> make) {
+    if(running_) throw std::logic_error("add tables while the scheduler is stopped");
+    const std::size_t id = route_.size();
+    const auto w = static_cast<unsigned>(id % workers_.size());
+    route_.push_back({w, kUnplaced});
+    base_.push_back(0);
+    pending_[w].emplace_back(id, std::move(make));
+    return id;
+}
+
+/* ── placement ────────────────────────────────────────────── */
+void Scheduler::pinHere(unsigned worker) const {
+    if(!cfg_.pin) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpuOf(worker), &set);
+    pthread_setaffinity_np(pthread_self(), sizeof set, &set);   // best effort
+}
+
+void Scheduler::buildOn(unsigned worker, const std::function<void()>& job) const {
+    std::exception_ptr err;
+    std::thread t([&] {
+        pinHere(worker);
+        try { job(); } catch(...) { err = std::current_exception(); }
+    });
+    t.join();
+    if(err) std::rethrow_exception(err);
+}
+
+/* ── running ──────────────────────────────────────────────── */
+void Scheduler::start() {
+    if(running_) return;
+    for(unsigned w=0; w<workers_.size(); ++w) {
+        auto& jobs = pending_[w];
+        if(jobs.empty()) continue;
+        std::vector<Table> built;
+        buildOn(w, [&] {
+            built.reserve(jobs.size());
+            for(auto& [id, make] : jobs) built.push_back(make());
+        });
+        for(std::size_t k=0;k<jobs.size();++k)
+            route_[jobs[k].first].local = workers_[w]->adopt(std::move(built[k]));
+        jobs.clear();
+    }
+    for(unsigned w=0; w<workers_.size(); ++w)
+        workers_[w]->start([this, w]{ pinHere(w); });
+    running_ = true;
+}
+
+void Scheduler::stop() {
+    if(!running_) return;
+    for(auto& w : workers_) w->stop();
+    running_ = false;
+}
+
+std::vector<std::uint64_t> Scheduler::load() const {
+    if(running_) throw std::logic_error("load() needs the scheduler stopped");
+    std::vector<std::uint64_t> out(workers_.size(), 0);
+    for(std::size_t id=0; id<route_.size(); ++id) {
+        const Route& r = route_[id];
+        if(r.local != kUnplaced) out[r.worker] += workers_[r.worker]->executed(r.local) - base_[id];
+    }
+    return out;
+}
+
+/* greedy: move the table from the busiest worker that best halves its gap
+   to the idlest one, until no move narrows the spread                     */
+std::size_t Scheduler::rebalance() {
+    const bool wasRunning = running_;
+    stop();
+
+    std::vector<std::uint64_t> perTable(route_.size(), 0);
+    for(std::size_t id=0; id<route_.size(); ++id) {
+        const Route& r = route_[id];
+        if(r.local != kUnplaced) perTable[id] = workers_[r.worker]->executed(r.local) - base_[id];
+    }
+    std::vector<std::uint64_t> sum = load();
+    std::vector<unsigned>      dest(route_.size());
+    for(std::size_t id=0; id<route_.size(); ++id) dest[id] = route_[id].worker;
+
+    std::size_t moves = 0;
+    for(std::size_t step=0; step<route_.size(); ++step) {
+        const auto hi = static_cast<unsigned>(std::max_element(sum.begin(), sum.end()) - sum.begin());
+        const auto lo = static_cast<unsigned>(std::min_element(sum.begin(), sum.end()) - sum.begin());
+        const std::uint64_t gap = sum[hi] - sum[lo];
+        std::size_t best = kUnplaced;
+        std::uint64_t bestGain = 0;
+        for(std::size_t id=0; id<route_.size(); ++id) {
+            if(dest[id] != hi || route_[id].local == kUnplaced || !perTable[id] || perTable[id] >= gap) continue;
+            const std::uint64_t gain = std::min(perTable[id], gap - perTable[id]);
+            if(gain > bestGain) { bestGain = gain; best = id; }
+        }
+        if(best == kUnplaced) break;
+        dest[best] = lo;
+        sum[hi] -= perTable[best];
+        sum[lo] += perTable[best];
+        ++moves;
+    }
+
+    if(moves) {
+        /* take every placed table back, rebuild the movers on their new CPU */
+        std::vector<Table> all(route_.size());
+        for(auto& w : workers_) {
+            std::vector<Table> back = w->release();
+            for(std::size_t id=0; id<route_.size(); ++id)
+                if(route_[id].local != kUnplaced && workers_[route_[id].worker].get() == w.get())
+                    all[id] = std::move(back[route_[id].local]);
+        }
+        for(unsigned w=0; w<workers_.size(); ++w)
+            buildOn(w, [&] {
+                for(std::size_t id=0; id<route_.size(); ++id)
+                    if(dest[id] == w && route_[id].worker != w && route_[id].local != kUnplaced)
+                        all[id] = all[id].copy();
+            });
+        for(std::size_t id=0; id<route_.size(); ++id) {
+            if(route_[id].local == kUnplaced) continue;
+            route_[id] = {dest[id], workers_[dest[id]]->adopt(std::move(all[id]))};
+        }
+    }
+    for(std::size_t id=0; id<route_.size(); ++id) {
+        const Route& r = route_[id];
+        base_[id] = r.local == kUnplaced ? 0 : workers_[r.worker]->executed(r.local);
+    }
+    if(wasRunning) start();
+    return moves;
+}
+
+/* ── commands ─────────────────────────────────────────────── */
+bool Scheduler::post(std::size_t id, TableExecutor::Command cmd) {
+    const Route r = route_.at(id);
+    return workers_[r.worker]->post(r.local, std::move(cmd));
+}
+
+std::future<void> Scheduler::perform(std::size_t id, const coup::Action& a) {
+    const Route r = route_.at(id);
+    return workers_[r.worker]->perform(r.local, a);
+}
+
+} // namespace coup_sim
@@ -0,0 +1,314 @@
+// thelet.shevach@gmail.com
+#include "sim/SelfPlay.hpp"
+#include "sim/Simulator.hpp"
+#include "sim/Table.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+using namespace coup_sim;
+using coup::Action;
+using coup::Game;
+
+/* ── ReplayBuffer ─────────────────────────────────────────── */
+namespace {
+
+constexpr char          kMagic[8]   = {'C','O','U','P','R','P','L','1'};
+constexpr std::size_t   kHeader     = 32;
+constexpr std::size_t   kRecord     = (kFeatures + 1) * sizeof(float);
+
+struct Header {
+    char          magic[8];
+    std::uint32_t features;
+    std::uint32_t reserved;
+    std::uint64_t capacity;
+    std::uint64_t written;
+};
+static_assert(sizeof(Header) == kHeader);
+
+} // namespace
+
+ReplayBuffer::ReplayBuffer(const std::string& path, std::size_t capacity)
+    : capacity_(std::max<std::size_t>(1, capacity))
+{
+    f_.open(path, std::ios::in | std::ios::out | std::ios::binary);
+    Header h{};
+    if(f_ && f_.read(reinterpret_cast<char*>(&h), sizeof h)
+          && std::memcmp(h.magic, kMagic, sizeof kMagic) == 0
+          && h.features == kFeatures && h.capacity == capacity_) {
+        written_ = h.written;
+        return;
+    }
+    f_.close();
+    f_.open(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    if(!f_) throw std::runtime_error("cannot open " + path);
+    writeHeader();
+}
+
+ReplayBuffer::~ReplayBuffer() {
+    try { flush(); } catch(...) {}
+}
+
+void ReplayBuffer::writeHeader() {
+    Header h{};
+    std::memcpy(h.magic, kMagic, sizeof kMagic);
+    h.features = kFeatures;
+    h.capacity = capacity_;
+    h.written  = written_;
+    f_.seekp(0);
+    f_.write(reinterpret_cast<const char*>(&h), sizeof h);
+    if(!f_) throw std::runtime_error("replay buffer: write failed");
+}
+
+void ReplayBuffer::flush() {
+    std::lock_guard<std::mutex> lock(m_);
+    writeHeader();
+    f_.flush();
+}
+
+void ReplayBuffer::append(const float* rows, const float* labels, std::size_t n) {
+    std::lock_guard<std::mutex> lock(m_);
+    std::uint64_t w = written_;
+    for(std::size_t i=0;i<n;++i, ++w) {
+        f_.seekp(std::streamoff(kHeader + (w % capacity_) * kRecord));
+        f_.write(reinterpret_cast<const char*>(rows + i * kFeatures), kFeatures * sizeof(float));
+        f_.write(reinterpret_cast<const char*>(labels + i), sizeof(float));
+    }
+    written_ = w;
+    writeHeader();
+}
+
+bool ReplayBuffer::sample(Rng& rng, std::size_t n, FeatureBatch& out, float* labels) {
+    std::lock_guard<std::mutex> lock(m_);
+    const std::size_t have = size();
+    if(!have) return false;
+    float rec[kFeatures + 1];
+    out.clear();
+    for(std::size_t i=0;i<n;++i) {
+        f_.seekg(std::streamoff(kHeader + rng.below(have) * kRecord));
+        if(!f_.read(reinterpret_cast<char*>(rec), kRecord))
+            throw std::runtime_error("replay buffer: read failed");
+        std::copy(rec, rec + kFeatures, out.push());
+        labels[i] = rec[kFeatures];
+    }
+    return true;
+}
+
+/* ── trainer ──────────────────────────────────────────────── */
+namespace {
+
+/* remembers every decision of `inner` from the mover's chair */
+class Recorder : public Bot {
+public:
+    Recorder(Bot& inner, std::vector<float>& rows, std::vector<std::uint8_t>& seats)
+        : inner_(inner), rows_(rows), seats_(seats) {}
+
+    std::string name() const override { return inner_.name(); }
+    Action choose(const Game& g, const std::vector<Action>& moves, Rng& rng) override {
+        const std::size_t me = g.turnIndex();
+        rows_.resize(rows_.size() + kFeatures);
+        extractFeatures(g, me, rows_.data() + rows_.size() - kFeatures);
+        seats_.push_back(static_cast<std::uint8_t>(me));
+        return inner_.choose(g, moves, rng);
+    }
+    bool react(const Game& g, std::size_t seat, Rng& rng) override { return inner_.react(g, seat, rng); }
+
+private:
+    Bot&                       inner_;
+    std::vector<float>&        rows_;
+    std::vector<std::uint8_t>& seats_;
+};
+
+float sigmoid(float z) { return 1.0f / (1.0f + std::exp(-z)); }
+
+/* adds d(log-loss)/d(params) for one row to `g`; returns the loss */
+double backprop(const EvalModel& m, const float* x, float y, EvalModel& g) {
+    constexpr std::size_t H = EvalModel::kHidden;
+    float p, d;
+    if(m.kind() == EvalModel::Kind::Linear) {
+        float z = m.linB;
+        for(std::size_t i=0;i<kFeatures;++i) z += m.lin[i] * x[i];
+        p = sigmoid(z);
+        d = p - y;
+        for(std::size_t i=0;i<kFeatures;++i) g.lin[i] += d * x[i];
+        g.linB += d;
+    } else {
+        float h[H];
+        std::copy(std::begin(m.b1), std::end(m.b1), h);
+        for(std::size_t i=0;i<kFeatures;++i) {
+            if(x[i] == 0.0f) continue;
+            for(std::size_t u=0;u<H;++u) h[u] += x[i] * m.w1[i*H + u];
+        }
+        float z = m.b2;
+        for(std::size_t u=0;u<H;++u) z += std::max(0.0f, h[u]) * m.w2[u];
+        p = sigmoid(z);
+        d = p - y;
+        for(std::size_t u=0;u<H;++u) {
+            g.w2[u] += d * std::max(0.0f, h[u]);
+            h[u] = h[u] > 0 ? d * m.w2[u] : 0.0f;      // now dL/dh
+            g.b1[u] += h[u];
+        }
+        g.b2 += d;
+        for(std::size_t i=0;i<kFeatures;++i) {
+            if(x[i] == 0.0f) continue;
+            for(std::size_t u=0;u<H;++u) g.w1[i*H + u] += x[i] * h[u];
+        }
+    }
+    const double q = std::clamp(double(p), 1e-7, 1 - 1e-7);
+    return -(y * std::log(q) + (1 - y) * std::log(1 - q));
+}
+
+template<std::size_t N>
+void sgd(float (&p)[N], const float (&g)[N], float scale, float lr, float l2) {
+    for(std::size_t i=0;i<N;++i) p[i] -= lr * (g[i] * scale + l2 * p[i]);
+}
+
+} // namespace
+
+SelfPlayTrainer::SelfPlayTrainer(const SelfPlayConfig& cfg, const EvalModel* start)
+    : cfg_(cfg), buffer_(cfg.buffer, cfg.capacity), master_(cfg.kind)
+{
+    if(cfg_.minPlayers < 2 || cfg_.maxPlayers < cfg_.minPlayers)
+        throw std::invalid_argument("self-play: bad player range");
+    if(cfg_.publishEvery == 0)
+        throw std::invalid_argument("self-play: publishEvery must be at least 1");
+    if(start) master_ = *start;
+    else { Rng rng(cfg_.seed); master_.randomize(rng, 0.1f); }
+    published_ = std::make_shared<const EvalModel>(master_);
+}
+
+EvalModel SelfPlayTrainer::model() const {
+    std::lock_guard<std::mutex> lock(m_);
+    return master_;
+}
+
+void SelfPlayTrainer::actor(unsigned w, std::size_t games) {
+    Rng rng(cfg_.seed ^ (0xA24BAED4963EE407ULL * (w + 1)));
+    RandomBot                 random;
+    GreedyBot                 greedy;
+    EvalBot                   eval(nullptr, cfg_.epsilon);
+    std::vector<float>        rows, labels;
+    std::vector<std::uint8_t> seats;
+    std::vector<Recorder>     rec;
+    std::vector<Bot*>         bots;
+    std::vector<Role>         roles;
+
+    for(std::size_t done=0; done<games && !stop_; ++done) {
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            eval.setModel(published_);
+        }
+        const std::size_t n = cfg_.minPlayers + rng.below(cfg_.maxPlayers - cfg_.minPlayers + 1);
+        roles.clear();
+        for(std::size_t i=0;i<n;++i) roles.push_back(static_cast<Role>(rng.below(kRoleCount)));
+        Table t = Table::deal(roles);
+
+        rows.clear();
+        seats.clear();
+        rec.clear();
+        bots.clear();
+        for(std::size_t i=0;i<n;++i) {
+            Bot& inner = rng.uniform() < cfg_.evalShare ? static_cast<Bot&>(eval)
+                       : rng.below(2) ? static_cast<Bot&>(greedy) : static_cast<Bot&>(random);
+            rec.emplace_back(inner, rows, seats);
+        }
+        for(auto& r : rec) bots.push_back(&r);
+
+        const GameResult res = playGame(*t.game, bots, rng, cfg_.maxTicks);
+
+        std::size_t alive = 0;
+        for(std::size_t i=0;i<n;++i) alive += t.game->alive(i);
+        labels.clear();
+        for(auto s : seats)
+            labels.push_back(res.winner != GameResult::noWinner ? float(res.winner == s)
+                             : t.game->alive(s) ? 1.0f / float(alive) : 0.0f);
+        buffer_.append(rows.data(), labels.data(), labels.size());
+
+        std::lock_guard<std::mutex> lock(m_);
+        ++stats_.games;
+        stats_.samples += labels.size();
+    }
+}
+
+void SelfPlayTrainer::step(EvalModel& grad, std::size_t n, double loss) {
+    const float s = 1.0f / float(n), lr = float(cfg_.lr), l2 = float(cfg_.l2);
+    if(master_.kind() == EvalModel::Kind::Linear) {
+        sgd(master_.lin, grad.lin, s, lr, l2);
+        master_.linB -= lr * grad.linB * s;
+    } else {
+        sgd(master_.w1, grad.w1, s, lr, l2);
+        sgd(master_.b1, grad.b1, s, lr, 0.0f);
+        sgd(master_.w2, grad.w2, s, lr, l2);
+        master_.b2 -= lr * grad.b2 * s;
+    }
+    const double mean = loss / double(n);
+    stats_.loss = stats_.steps ? 0.98 * stats_.loss + 0.02 * mean : mean;
+    if(++stats_.steps % cfg_.publishEvery == 0)
+        published_ = std::make_shared<const EvalModel>(master_);
+}
+
+void SelfPlayTrainer::learner(unsigned w) {
+    Rng          rng(cfg_.seed ^ (0x9E3779B97F4A7C15ULL * (w + 1)));
+    EvalModel    local = model();
+    EvalModel    grad(cfg_.kind);
+    const std::size_t batch = std::max<std::size_t>(1, cfg_.batch);
+    FeatureBatch rows(batch);
+    std::vector<float> labels(batch);
+
+    while(!stop_) {
+        const bool acting = actorsLeft_ > 0;
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            if(!acting && stats_.steps >= cfg_.steps) break;
+        }
+        if(buffer_.size() < (acting ? std::min(cfg_.warmup, buffer_.capacity()) : 1)) {
+            if(!acting) break;                           // nothing was ever recorded
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        buffer_.sample(rng, batch, rows, labels.data());
+
+        grad = EvalModel(cfg_.kind);
+        double loss = 0;
+        for(std::size_t i=0;i<batch;++i) loss += backprop(local, rows.row(i), labels[i], grad);
+
+        std::lock_guard<std::mutex> lock(m_);
+        step(grad, batch, loss);
+        local = master_;
+    }
+}
+
+SelfPlayStats SelfPlayTrainer::train() {
+    const unsigned nActors = std::max(1u, cfg_.actors), nLearners = std::max(1u, cfg_.learners);
+    actorsLeft_ = nActors;
+    stop_       = false;
+    error_      = nullptr;
+
+    /* the first failure is kept and stops every other thread */
+    auto guarded = [this](auto&& body) {
+        try { body(); }
+        catch(...) {
+            std::lock_guard<std::mutex> lock(m_);
+            if(!error_) error_ = std::current_exception();
+            stop_ = true;
+        }
+    };
+    std::vector<std::thread> pool;
+    for(unsigned w=0; w<nActors; ++w)
+        pool.emplace_back([this, guarded, w, games = cfg_.games * (w+1) / nActors - cfg_.games * w / nActors] {
+            guarded([&]{ actor(w, games); });
+            --actorsLeft_;
+        });
+    for(unsigned w=0; w<nLearners; ++w)
+        pool.emplace_back([this, guarded, w] { guarded([&]{ learner(w); }); });
+    for(auto& t : pool) t.join();
+    if(error_) std::rethrow_exception(error_);
+    buffer_.flush();
+
+    std::lock_guard<std::mutex> lock(m_);
+    published_ = std::make_shared<const EvalModel>(master_);
+    return stats_;
+}
@@ -0,0 +1,67 @@
+// thelet.shevach@gmail.com
+#include "sim/Simulator.hpp"
+#include "sim/MoveGen.hpp"
+
+using namespace coup_sim;
+using coup::Action;
+using coup::Game;
+
+static BlockKind kindOf(Action::Type t) {
+    return t==Action::Type::Tax   ? BlockTax
+         : t==Action::Type::Bribe ? BlockBribe
+         :                          BlockCoup;
+}
+
+GameResult coup_sim::playGame(Game& g, const std::vector<Bot*>& bots, Rng& rng,
+                              std::size_t maxTicks, std::vector<Action>* log)
+{
+    GameResult res;
+    std::vector<Action> moves;
+    const std::size_t n = g.roster().size();
+
+    while(g.tick() < maxTicks) {
+        if(g.isOver()) {
+            if(g.aliveCount()) res.winner = g.winnerIndex();
+            break;
+        }
+
+        const std::size_t me = g.turnIndex();
+        moves.clear();
+        legalMoves(g, moves);
+        if(moves.empty()) break;                       // stuck → draw
+
+        const Action a = bots[me]->choose(g, moves, rng);
+        ++res.actions;
+        if(log) log->push_back(a);
+        if(!blockable(a.type)) { apply(g, a); continue; }
+
+        /* reaction window: the action is only proposed until nobody blocks */
+        g.propose(a);
+        bool blocked = false;
+        for(std::size_t k=1; k<n && !blocked; ++k) {
+            const std::size_t s = (me + k) % n;
+            if(canBlock(g,s) && bots[s]->react(g, s, rng)) {
+                g.block({Action::Type::Block, s, {}});
+                ++res.blocks[kindOf(a.type)];
+                ++res.actions;
+                if(log) log->push_back({Action::Type::Block, s, {}});
+                blocked = true;
+            }
+        }
+        if(!blocked) g.commit();
+    }
+    res.ticks = g.tick();
+    return res;
+}
+
+void coup_sim::replayGame(Game& g, const std::vector<Action>& log,
+                          const std::function<void(const Action&)>& before)
+{
+    for(std::size_t i=0;i<log.size();++i) {
+        const Action& a = log[i];
+        if(before) before(a);
+        if(!blockable(a.type)) { apply(g, a); continue; }
+        g.propose(a);
+        if(i+1 == log.size() || log[i+1].type != Action::Type::Block) g.commit();
+    }
+}
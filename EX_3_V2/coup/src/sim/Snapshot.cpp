@@ -0,0 +1,341 @@
+// thelet.shevach@gmail.com
+#include "sim/Snapshot.hpp"
+#include "sim/MoveGen.hpp"
+
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace coup_sim {
+
+namespace {
+
+constexpr char          kSnapMagic[8] = {'C','O','U','P','S','N','P','2'};
+constexpr char          kTailMagic[8] = {'C','O','U','P','T','A','L','1'};
+constexpr std::uint32_t kNone         = 0xFFFFFFFFu;
+constexpr std::uint8_t  kNoBlockable  = 0xFF;
+constexpr std::size_t   kTableBytes   = 40;
+constexpr std::size_t   kSeatBytes    = 16;
+constexpr std::size_t   kTailBytes    = 24;
+
+struct SnapHeader {
+    char          magic[8];
+    std::uint64_t tables;
+    std::uint64_t tailMark;
+    std::uint64_t payload;
+    std::uint64_t checksum;
+};
+
+std::uint64_t fnv1a(const unsigned char* p, std::size_t n) {
+    std::uint64_t h = 14695981039346656037ull;
+    for(std::size_t i=0;i<n;++i) { h ^= p[i]; h *= 1099511628211ull; }
+    return h;
+}
+
+/* ── fixed-width fields ──────────────────────────────────────── */
+template<class T> void put(std::vector<unsigned char>& out, T v) {
+    const auto at = out.size();
+    out.resize(at + sizeof v);
+    std::memcpy(out.data() + at, &v, sizeof v);
+}
+template<class T> T get(const unsigned char* p) {
+    T v;
+    std::memcpy(&v, p, sizeof v);
+    return v;
+}
+
+std::uint32_t seat32(std::size_t s) {
+    return s == static_cast<std::size_t>(-1) ? kNone : static_cast<std::uint32_t>(s);
+}
+std::size_t seatOf(std::uint32_t s) {
+    return s == kNone ? static_cast<std::size_t>(-1) : s;
+}
+
+void writeAll(int fd, const void* data, std::size_t n) {
+    auto* p = static_cast<const unsigned char*>(data);
+    while(n) {
+        const ssize_t w = ::write(fd, p, n);
+        if(w < 0) throw std::runtime_error("snapshot: write failed");
+        p += w;
+        n -= static_cast<std::size_t>(w);
+    }
+}
+
+/* the rename is only durable once the directory entry is */
+void syncDir(const std::string& path) {
+    const auto slash = path.find_last_of('/');
+    const std::string dir = slash == std::string::npos ? "." : path.substr(0, slash + 1);
+    const int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if(fd < 0) return;
+    ::fsync(fd);
+    ::close(fd);
+}
+
+void encodeTail(unsigned char* rec, std::uint32_t table, const coup::Action& a, TailOp op) {
+    std::memset(rec, 0, kTailBytes);
+    const std::uint32_t actor  = seat32(a.actor);
+    const std::uint32_t target = a.target ? seat32(*a.target) : kNone;
+    std::memcpy(rec,      &table,  4);
+    std::memcpy(rec + 4,  &actor,  4);
+    std::memcpy(rec + 8,  &target, 4);
+    rec[12] = static_cast<unsigned char>(a.type);
+    rec[13] = static_cast<unsigned char>(op);
+    const auto sum = static_cast<std::uint32_t>(fnv1a(rec, 16));
+    std::memcpy(rec + 16, &sum, 4);
+}
+
+bool decodeTail(const unsigned char* rec, TailRecord& r) {
+    if(get<std::uint32_t>(rec + 16) != static_cast<std::uint32_t>(fnv1a(rec, 16))) return false;
+    if(rec[12] > static_cast<unsigned char>(coup::Action::Type::SpyPeek))          return false;
+    if(rec[13] > static_cast<unsigned char>(TailOp::Commit))                      return false;
+    coup::Action& a = r.action;
+    r.table  = get<std::uint32_t>(rec);
+    r.op     = static_cast<TailOp>(rec[13]);
+    a.type   = static_cast<coup::Action::Type>(rec[12]);
+    a.actor  = get<std::uint32_t>(rec + 4);
+    const auto target = get<std::uint32_t>(rec + 8);
+    a.target = target == kNone ? std::nullopt : std::optional<std::size_t>(target);
+    return true;
+}
+
+/* u8 type (0xFF = none), 3×u8 0, u32 actor, u32 target */
+std::optional<coup::Action> actionAt(const unsigned char* p) {
+    if(p[0] == kNoBlockable) return std::nullopt;
+    if(p[0] > static_cast<std::uint8_t>(coup::Action::Type::SpyPeek)) throw std::runtime_error("snapshot: unknown action");
+    const auto target = get<std::uint32_t>(p + 8);
+    return coup::Action{static_cast<coup::Action::Type>(p[0]), seatOf(get<std::uint32_t>(p + 4)),
+                        target == kNone ? std::nullopt : std::optional<std::size_t>(target)};
+}
+
+} // namespace
+
+/* ── snapshot writer ─────────────────────────────────────────── */
+void saveSnapshot(const std::string& path, const std::vector<const Table*>& tables,
+                  std::uint64_t tailMark) {
+    std::vector<unsigned char> body;
+    std::size_t bytes = 0;
+    for(const Table* t : tables) bytes += kTableBytes + t->seats.size() * kSeatBytes;
+    body.reserve(bytes);
+
+    for(const Table* t : tables) {
+        const coup::Game::State s = t->game->state();
+        put<std::uint32_t>(body, static_cast<std::uint32_t>(s.seats.size()));
+        put<std::uint32_t>(body, static_cast<std::uint32_t>(s.turn));
+        put<std::uint32_t>(body, static_cast<std::uint32_t>(s.tick));
+        put<std::uint32_t>(body, static_cast<std::uint32_t>(s.blockableExpires));
+        put<std::uint8_t >(body, s.blockable ? static_cast<std::uint8_t>(s.blockable->type) : kNoBlockable);
+        put<std::uint8_t >(body, 0); put<std::uint8_t>(body, 0); put<std::uint8_t>(body, 0);
+        put<std::uint32_t>(body, s.blockable ? seat32(s.blockable->actor) : kNone);
+        put<std::uint32_t>(body, s.blockable && s.blockable->target ? seat32(*s.blockable->target) : kNone);
+        put<std::uint8_t >(body, s.pending ? static_cast<std::uint8_t>(s.pending->type) : kNoBlockable);
+        put<std::uint8_t >(body, 0); put<std::uint8_t>(body, 0); put<std::uint8_t>(body, 0);
+        put<std::uint32_t>(body, s.pending ? seat32(s.pending->actor) : kNone);
+        put<std::uint32_t>(body, s.pending && s.pending->target ? seat32(*s.pending->target) : kNone);
+        for(std::size_t i=0;i<s.seats.size();++i) {
+            const auto& seat = s.seats[i];
+            put<std::uint8_t >(body, static_cast<std::uint8_t>(roleOf(*t->seats[i])));
+            put<std::uint8_t >(body, seat.alive ? 1 : 0);
+            put<std::uint16_t>(body, 0);
+            put<std::int32_t >(body, seat.coins);
+            put<std::uint32_t>(body, seat32(seat.lastArrested));
+            put<std::uint32_t>(body, static_cast<std::uint32_t>(seat.sanctionedUntil));
+        }
+    }
+
+    SnapHeader h{};
+    std::memcpy(h.magic, kSnapMagic, sizeof kSnapMagic);
+    h.tables   = tables.size();
+    h.tailMark = tailMark;
+    h.payload  = body.size();
+    h.checksum = fnv1a(body.data(), body.size());
+
+    const std::string tmp = path + ".tmp";
+    const int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0) throw std::runtime_error("cannot open " + tmp);
+    try {
+        writeAll(fd, &h, sizeof h);
+        writeAll(fd, body.data(), body.size());
+        if(::fsync(fd) != 0) throw std::runtime_error("snapshot: fsync failed");
+    } catch(...) {
+        ::close(fd);
+        ::unlink(tmp.c_str());
+        throw;
+    }
+    if(::close(fd) != 0 || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        ::unlink(tmp.c_str());
+        throw std::runtime_error("cannot write snapshot " + path);
+    }
+    syncDir(path);
+}
+
+/* ── snapshot reader ─────────────────────────────────────────── */
+SnapshotFile::SnapshotFile(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) throw std::runtime_error("cannot open " + path);
+    struct stat st{};
+    if(::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(SnapHeader)) {
+        ::close(fd);
+        throw std::runtime_error("bad snapshot " + path);
+    }
+    bytes_ = static_cast<std::size_t>(st.st_size);
+    void* m = ::mmap(nullptr, bytes_, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    ::close(fd);
+    if(m == MAP_FAILED) throw std::runtime_error("cannot map " + path);
+    base_ = static_cast<const unsigned char*>(m);
+
+    const auto h = get<SnapHeader>(base_);
+    const unsigned char* body = base_ + sizeof h;
+    const std::size_t    room = bytes_ - sizeof h;
+    bool ok = std::memcmp(h.magic, kSnapMagic, sizeof kSnapMagic) == 0
+           && h.payload == room
+           && h.checksum == fnv1a(body, room);
+
+    /* index the variable-length table records */
+    std::size_t at = 0;
+    if(ok) offsets_.reserve(h.tables);
+    for(std::uint64_t i=0; ok && i<h.tables; ++i) {
+        ok = at + kTableBytes <= room;
+        if(!ok) break;
+        const std::size_t seats = get<std::uint32_t>(body + at);
+        ok = seats <= (room - at - kTableBytes) / kSeatBytes;
+        offsets_.push_back(sizeof h + at);
+        at += kTableBytes + seats * kSeatBytes;
+    }
+    if(!ok || at != room) {
+        ::munmap(const_cast<unsigned char*>(base_), bytes_);
+        base_ = nullptr;
+        throw std::runtime_error("corrupt snapshot " + path);
+    }
+    tailMark_ = h.tailMark;
+}
+
+SnapshotFile::~SnapshotFile() {
+    if(base_) ::munmap(const_cast<unsigned char*>(base_), bytes_);
+}
+
+std::vector<Role> SnapshotFile::roles(std::size_t i) const {
+    const unsigned char* p = base_ + offsets_.at(i);
+    const std::size_t    n = get<std::uint32_t>(p);
+    std::vector<Role> out(n);
+    for(std::size_t s=0;s<n;++s) {
+        const std::uint8_t r = p[kTableBytes + s*kSeatBytes];
+        if(r >= kRoleCount) throw std::runtime_error("snapshot: unknown role");
+        out[s] = static_cast<Role>(r);
+    }
+    return out;
+}
+
+coup::Game::State SnapshotFile::state(std::size_t i) const {
+    const unsigned char* p = base_ + offsets_.at(i);
+    coup::Game::State s;
+    const std::size_t n = get<std::uint32_t>(p);
+    s.turn             = get<std::uint32_t>(p + 4);
+    s.tick             = get<std::uint32_t>(p + 8);
+    s.blockableExpires = get<std::uint32_t>(p + 12);
+    s.blockable = actionAt(p + 16);
+    s.pending   = actionAt(p + 28);
+    s.seats.resize(n);
+    for(std::size_t k=0;k<n;++k) {
+        const unsigned char* q = p + kTableBytes + k*kSeatBytes;
+        s.seats[k] = {get<std::int32_t>(q + 4), seatOf(get<std::uint32_t>(q + 8)),
+                      get<std::uint32_t>(q + 12), q[1] != 0};
+    }
+    return s;
+}
+
+Table SnapshotFile::restore(std::size_t i) const {
+    Table t = Table::deal(roles(i));
+    t.game->load(state(i));
+    return t;
+}
+
+std::vector<Table> SnapshotFile::restoreAll() const {
+    std::vector<Table> out;
+    out.reserve(size());
+    for(std::size_t i=0;i<size();++i) out.push_back(restore(i));
+    return out;
+}
+
+/* ── action tail ─────────────────────────────────────────────── */
+ActionTail::ActionTail(const std::string& path) {
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if(fd_ < 0) throw std::runtime_error("cannot open " + path);
+    struct stat st{};
+    char magic[sizeof kTailMagic]{};
+    const bool fresh = ::fstat(fd_, &st) != 0
+                    || static_cast<std::size_t>(st.st_size) < sizeof kTailMagic
+                    || ::pread(fd_, magic, sizeof magic, 0) != static_cast<ssize_t>(sizeof magic)
+                    || std::memcmp(magic, kTailMagic, sizeof kTailMagic) != 0;
+    if(fresh) {
+        if(::ftruncate(fd_, 0) != 0
+        || ::pwrite(fd_, kTailMagic, sizeof kTailMagic, 0) != static_cast<ssize_t>(sizeof kTailMagic)) {
+            ::close(fd_);
+            throw std::runtime_error("cannot initialise tail " + path);
+        }
+    } else {
+        /* keep the longest prefix of whole, valid records */
+        records_ = (static_cast<std::size_t>(st.st_size) - sizeof kTailMagic) / kTailBytes;
+        const auto kept = read(0).size();
+        records_ = kept;
+        if(::ftruncate(fd_, static_cast<off_t>(sizeof kTailMagic + kept * kTailBytes)) != 0) {
+            ::close(fd_);
+            throw std::runtime_error("cannot repair tail " + path);
+        }
+    }
+    ::lseek(fd_, 0, SEEK_END);
+}
+
+ActionTail::~ActionTail() {
+    if(fd_ >= 0) ::close(fd_);
+}
+
+void ActionTail::append(std::uint32_t table, const coup::Action& a, TailOp op) {
+    unsigned char rec[kTailBytes];
+    encodeTail(rec, table, a, op);
+    writeAll(fd_, rec, sizeof rec);
+    ++records_;
+}
+
+void ActionTail::sync() {
+    if(::fdatasync(fd_) != 0) throw std::runtime_error("tail: fdatasync failed");
+}
+
+/* stops at the first bad record: everything after it is unreliable */
+std::vector<TailRecord> ActionTail::read(std::uint64_t from) const {
+    std::vector<TailRecord> out;
+    if(from >= records_) return out;
+    std::vector<unsigned char> buf((records_ - from) * kTailBytes);
+    const auto got = ::pread(fd_, buf.data(), buf.size(),
+                             static_cast<off_t>(sizeof kTailMagic + from * kTailBytes));
+    const std::size_t whole = got < 0 ? 0 : static_cast<std::size_t>(got) / kTailBytes;
+    out.reserve(whole);
+    TailRecord rec{};
+    for(std::size_t r=0; r<whole && decodeTail(buf.data() + r*kTailBytes, rec); ++r)
+        out.push_back(rec);
+    return out;
+}
+
+/* ── recovery ────────────────────────────────────────────────── */
+std::vector<Table> recover(const std::string& snapshot, const std::string& tail) {
+    const SnapshotFile snap(snapshot);
+    std::vector<Table> tables = snap.restoreAll();
+    const ActionTail log(tail);
+    log.replay(snap.tailMark(), [&](const TailRecord& r) {
+        coup::Game& g = *tables.at(r.table).game;
+        switch(r.op) {
+        case TailOp::Apply:   apply(g, r.action);   break;
+        case TailOp::Propose: g.propose(r.action);  break;
+        case TailOp::Commit:
+            try { g.commit(); }
+            catch(const std::exception&) {}        // rejected live too: the proposal was dropped there as well
+            break;
+        }
+    });
+    return tables;
+}
+
+} // namespace coup_sim
@@ -0,0 +1,54 @@
+// thelet.shevach@gmail.com
+#include "sim/Table.hpp"
+
+using namespace coup_sim;
+using coup::Player;
+
+static constexpr std::array<const char*,kRoleCount> kNames = {
+    "Governor", "Spy", "Baron", "General", "Judge", "Merchant"
+};
+
+const char* coup_sim::roleName(Role r) { return kNames[static_cast<std::size_t>(r)]; }
+
+/* hot in move generation: the six names differ in their first letter,
+   except Governor / General, which differ in the third                 */
+Role coup_sim::roleOf(const Player& p) {
+    const std::string r = p.role();
+    switch(r.empty() ? '\0' : r[0]) {
+    case 'G': return r.size() > 2 && r[2] == 'v' ? Role::Governor : Role::General;
+    case 'S': return Role::Spy;
+    case 'B': return Role::Baron;
+    case 'J': return Role::Judge;
+    default:  return Role::Merchant;
+    }
+}
+
+std::unique_ptr<Player> coup_sim::makePlayer(coup::Game& g, Role r, const std::string& name) {
+    switch(r) {
+    case Role::Governor: return std::make_unique<coup::Governor>(g,name);
+    case Role::Spy:      return std::make_unique<coup::Spy>(g,name);
+    case Role::Baron:    return std::make_unique<coup::Baron>(g,name);
+    case Role::General:  return std::make_unique<coup::General>(g,name);
+    case Role::Judge:    return std::make_unique<coup::Judge>(g,name);
+    default:             return std::make_unique<coup::Merchant>(g,name);
+    }
+}
+
+Table Table::deal(const std::vector<Role>& roles) {
+    Table t;
+    t.game = std::make_unique<coup::Game>();
+    t.seats.reserve(roles.size());
+    for(std::size_t i=0;i<roles.size();++i)
+        t.seats.push_back(makePlayer(*t.game, roles[i], "P" + std::to_string(i+1)));
+    return t;
+}
+
+Table Table::copy() const {
+    Table t;
+    t.game = std::make_unique<coup::Game>();
+    t.seats.reserve(seats.size());
+    for(const auto& p : seats)
+        t.seats.push_back(makePlayer(*t.game, roleOf(*p), p->name()));
+    t.game->load(game->state());
+    return t;
+}
@@ -0,0 +1,105 @@
+// thelet.shevach@gmail.com
+#include "sim/TimingWheel.hpp"
+#include <algorithm>
+
+namespace coup_sim {
+
+TimingWheel::TimingWheel(std::function<void(std::uint64_t)> onFire)
+    : onFire_(std::move(onFire))
+{
+    heads_.fill(kNil);
+}
+
+/* level L holds timers due within 256^(L+1) ticks; a slot on level L is
+   emptied (cascaded down) when the clock crosses its 256^L boundary, which
+   is never later than any expiry it holds                                */
+void TimingWheel::place(std::uint32_t n) {
+    Node& t = nodes_[n];
+    const std::uint64_t delta = t.expires > now_ ? t.expires - now_ : 0;
+    unsigned level = 0;
+    while(level + 1 < kLevels && delta >= (std::uint64_t{1} << (kBits * (level + 1)))) ++level;
+    /* beyond the top level: park where the clock will look last, re-place then */
+    const std::uint64_t at = level + 1 == kLevels && delta >> (kBits * kLevels)
+                           ? now_ + ((std::uint64_t{1} << (kBits * kLevels)) - 1)
+                           : t.expires;
+    const std::uint32_t slot = level * kSlots + static_cast<std::uint32_t>((at >> (kBits * level)) & (kSlots - 1));
+    t.slot = slot;
+    t.prev = kNil;
+    t.next = heads_[slot];
+    if(t.next != kNil) nodes_[t.next].prev = n;
+    heads_[slot] = n;
+}
+
+void TimingWheel::detach(std::uint32_t n) {
+    Node& t = nodes_[n];
+    if(t.prev != kNil) nodes_[t.prev].next = t.next;
+    else               heads_[t.slot]      = t.next;
+    if(t.next != kNil) nodes_[t.next].prev = t.prev;
+    t.prev = t.next = kNil;
+}
+
+TimingWheel::TimerId TimingWheel::schedule(std::uint64_t delay, std::uint64_t payload) {
+    std::uint32_t n;
+    if(!free_.empty()) { n = free_.back(); free_.pop_back(); }
+    else               { n = static_cast<std::uint32_t>(nodes_.size()); nodes_.emplace_back(); }
+    Node& t = nodes_[n];
+    t.expires = now_ + std::max<std::uint64_t>(delay, 1);
+    t.payload = payload;
+    place(n);
+    ++armed_;
+    return static_cast<TimerId>(t.gen) << 32 | n;
+}
+
+bool TimingWheel::cancel(TimerId id) {
+    const auto n = static_cast<std::uint32_t>(id);
+    if(n >= nodes_.size()) return false;
+    Node& t = nodes_[n];
+    if(t.slot == kNil || t.gen != static_cast<std::uint32_t>(id >> 32)) return false;
+    detach(n);
+    t.slot = kNil;
+    ++t.gen;                                       // stale ids stop matching
+    free_.push_back(n);
+    --armed_;
+    return true;
+}
+
+std::size_t TimingWheel::tick() {
+    ++now_;
+    /* cascade: level L's current slot comes down whenever the lower
+       levels have just wrapped – highest first, so nothing lands in a
+       lower slot that was already emptied this tick                      */
+    unsigned wrapped = 0;
+    while(wrapped + 1 < kLevels && !(now_ & ((std::uint64_t{1} << (kBits * (wrapped + 1))) - 1))) ++wrapped;
+    for(unsigned level=wrapped; level>=1; --level) {
+        const std::uint32_t slot = level * kSlots + static_cast<std::uint32_t>((now_ >> (kBits * level)) & (kSlots - 1));
+        std::uint32_t n = heads_[slot];
+        heads_[slot] = kNil;
+        while(n != kNil) {
+            const std::uint32_t next = nodes_[n].next;
+            place(n);
+            n = next;
+        }
+    }
+    /* fire the current level-0 slot; callbacks may schedule or cancel */
+    const std::uint32_t slot = static_cast<std::uint32_t>(now_ & (kSlots - 1));
+    std::size_t fired = 0;
+    while(heads_[slot] != kNil) {
+        const std::uint32_t n = heads_[slot];
+        const std::uint64_t payload = nodes_[n].payload;
+        cancel(static_cast<TimerId>(nodes_[n].gen) << 32 | n);
+        onFire_(payload);
+        ++fired;
+    }
+    return fired;
+}
+
+std::size_t TimingWheel::advance(std::uint64_t ticks) {
+    std::size_t fired = 0;
+    for(std::uint64_t k=0; k<ticks; ++k) {
+        if(!armed_) { now_ += ticks - k; break; }     // nothing to cascade or fire
+        fired += tick();
+    }
+    return fired;
+}
+
+} // namespace coup_sim
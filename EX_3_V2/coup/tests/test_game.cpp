@@ -5,6 +5,8 @@
 #include "core/Game.hpp"
 #include "core/Player.hpp"
 
+#include <functional>
+#include <memory>
 #include <vector>
 #include <string>
 using namespace coup;
@@ -12,11 +14,11 @@ using namespace coup;
 //───────────────────────────────────────────────────────────────────────────────
 // Advance the game until it's target's turn. Everybody else just gathers.
 static void advanceTo(Game& g, const std::vector<Player*>& ps, Player* target) {
-    while (g.turn() != target->name()) {
-        const std::string cur = g.turn();
+    while (g.turnIndex() != target->seat()) {
+        const std::size_t cur = g.turnIndex();
         bool acted = false;
         for (auto p : ps) {
-            if (p->name() == cur) {
+            if (p->seat() == cur) {
                 p->gather();
                 acted = true;
                 break;
@@ -132,6 +134,15 @@ TEST_CASE("9. Baron sanctioned") {
     a.sanction(b);
     // a paid 3 then got rebate 1 => net -3 from start 3 => 0
     CHECK(a.coins()==0);
+    // a sanction still running on the Baron's turn also bars investing
+    Game::State s = g.state();
+    s.turn = b.seat();
+    s.seats[b.seat()].coins           = 3;
+    s.seats[b.seat()].sanctionedUntil = g.tick() + 2;
+    g.load(s);
+    CHECK_THROWS_AS(b.invest(), IllegalAction);
+    CHECK(b.coins()==3);
+    CHECK(g.turn()=="B");
 }
 
 TEST_CASE("10. General refunded upon arrest") {
@@ -240,3 +251,456 @@ TEST_CASE("18. Spy peek returns correct coins") {
 
 
 
+
+TEST_CASE("19. Delta reports coins, turn, coup and revive") {
+    Game g;
+    Spy a(g,"A"); General gen(g,"G"); Spy c(g,"C");
+    std::vector<Delta> seen;
+    g.subscribe([&](const Delta& d){ seen.push_back(d); });
+
+    a.gather();
+    REQUIRE(seen.size()==1);
+    CHECK(seen[0].nCoins==1);
+    CHECK(seen[0].coins[0].seat==0);
+    CHECK(seen[0].coins[0].value==1);
+    CHECK(seen[0].turn==1);
+    CHECK(seen[0].died==Delta::none);
+
+    gen.addCoins(5);
+    c.addCoins(7);
+    gen.gather();
+    c.coup(a);
+    CHECK(seen.back().died==0);
+    gen.blockCoup(c);
+    CHECK(seen.back().revived==0);
+    CHECK(seen.back().turn==Delta::none);
+}
+
+TEST_CASE("20. Encoded delta stream replays to the same table") {
+    Game g;
+    Governor gov(g,"Gov"); Spy s(g,"S"); Baron b(g,"B");
+    std::vector<Player*> ps{&gov,&s,&b};
+    DeltaStream stream;
+    g.subscribe(std::ref(stream));
+
+    for(int round=0; round<3; ++round){ gov.tax(); s.gather(); b.tax(); }
+    gov.undo(b);
+    gov.coup(s);
+
+    std::vector<int>  coins(3,0);
+    std::vector<bool> alive(3,true);
+    std::size_t       turn = 0;
+    stream.replay([&](const Delta& d){
+        for(std::uint8_t i=0;i<d.nCoins;++i) coins[d.coins[i].seat] = int(d.coins[i].value);
+        if(d.died!=Delta::none)    alive[d.died]    = false;
+        if(d.revived!=Delta::none) alive[d.revived] = true;
+        if(d.turn!=Delta::none)    turn = d.turn;
+    });
+    for(std::size_t i=0;i<3;++i){
+        CHECK(coins[i]==ps[i]->coins());
+        CHECK(alive[i]==g.alive(i));
+    }
+    CHECK(turn==g.turnIndex());
+    CHECK(stream.count()==11);
+    CHECK(stream.averageSize()<16.0);
+}
+
+TEST_CASE("21. Targets must be other living players") {
+    Game g;
+    Spy a(g,"A"), b(g,"B"), c(g,"C");
+    General dead(g,"D");
+    std::vector<Player*> ps{&a,&b,&c,&dead};
+    a.addCoins(14);
+    advanceTo(g,ps,&a);
+    a.coup(dead);
+    CHECK_THROWS_AS(dead.blockCoup(a), NotEnoughCoins); // may block their own coup, for 5
+    advanceTo(g,ps,&a);
+    CHECK_THROWS_AS(a.coup(a), IllegalAction);          // would leave nobody alive
+    CHECK_THROWS_AS(a.coup(dead), IllegalAction);       // already out
+    dead.addCoins(5);
+    CHECK_THROWS_AS(dead.blockCoup(a), IllegalAction);  // the window closed on A's turn
+    CHECK(a.coins()==7);
+
+    a.coup(b);
+    advanceTo(g,ps,&a);
+    c.addCoins(7);
+    advanceTo(g,ps,&c);
+    c.coup(a);
+    CHECK(g.winner()=="C");
+    CHECK_THROWS_AS(c.coup(c), IllegalAction);
+}
+
+TEST_CASE("22. Large tables: seat lookup and alive count stay exact") {
+    Game g, other;
+    std::vector<std::unique_ptr<Player>> seats;
+    for(int i=0;i<300;++i) seats.push_back(std::make_unique<Spy>(g,"P"+std::to_string(i)));
+    Spy stranger(other,"X");
+    for(std::size_t i=0;i<seats.size();++i) CHECK(g.indexOf(*seats[i])==i);
+    CHECK_THROWS_AS(g.indexOf(stranger), NoSuchPlayer);
+    CHECK(g.aliveCount()==300);
+
+    seats[0]->addCoins(7*299);
+    for(std::size_t v=299; v>=1; --v) {
+        while(g.turnIndex()!=0) {
+            Player& p = *seats[g.turnIndex()];
+            if(p.coins()>=9) p.spendCoins(9);            // stay clear of the forced coup
+            p.gather();
+        }
+        seats[0]->coup(*seats[v]);
+        CHECK(g.aliveCount()==v);
+        if(v>1) CHECK_THROWS_AS(g.winner(), GameNotFinished);
+    }
+    CHECK(g.winner()=="P0");
+    CHECK(g.players()==std::vector<std::string>{"P0"});
+}
+
+/* next living seat by brute force */
+static std::size_t scanNext(const Game& g, std::size_t i) {
+    do { i = (i + 1) % g.roster().size(); } while(!g.alive(i));
+    return i;
+}
+
+TEST_CASE("23. Living-seat ring follows coups, revives and load") {
+    Game g;
+    std::vector<std::unique_ptr<Player>> seats;
+    for(int i=0;i<40;++i) {
+        if(i%10==5) seats.push_back(std::make_unique<General>(g,"G"+std::to_string(i)));
+        else        seats.push_back(std::make_unique<Spy>(g,"P"+std::to_string(i)));
+    }
+    auto ringOk = [&]{
+        for(std::size_t i=0;i<seats.size();++i)
+            if(g.alive(i) && (g.nextAlive(i)!=scanNext(g,i) || g.prevAlive(scanNext(g,i))!=i)) return false;
+        return true;
+    };
+    CHECK(ringOk());
+
+    /* seat 0 coups 1..4, seat 5 (General) revives the latest victim */
+    seats[0]->addCoins(28);
+    seats[5]->addCoins(5);
+    for(std::size_t v=1; v<=4; ++v) {
+        while(g.turnIndex()!=0) seats[g.turnIndex()]->gather();
+        seats[0]->coup(*seats[v]);
+    }
+    CHECK_FALSE(g.alive(4));
+    CHECK(ringOk());
+    CHECK(g.turnIndex()==5);
+    CHECK(g.nextAlive(0)==5);
+    CHECK_THROWS_AS(seats[0]->coup(*seats[2]), NotYourTurn);
+
+    dynamic_cast<General&>(*seats[5]).blockCoup(*seats[0]);
+    CHECK(g.alive(4));
+    CHECK(ringOk());
+    CHECK(g.nextAlive(0)==4);
+
+    /* a loaded position rebuilds the ring, dead seats point onwards */
+    Game::State s = g.state();
+    for(std::size_t i=0;i<s.seats.size();++i) s.seats[i].alive = i%3==0;
+    s.turn = 3;
+    g.load(s);
+    CHECK(ringOk());
+    CHECK(g.aliveCount()==14);
+    CHECK(g.nextAlive(3)==6);
+
+    /* malformed states are refused and leave the table as it was */
+    Game::State bad = s;
+    bad.turn = 1;                                          // a dead seat
+    CHECK_THROWS_AS(g.load(bad), IllegalAction);
+    bad.turn = s.seats.size();
+    CHECK_THROWS_AS(g.load(bad), IllegalAction);
+    bad = s;
+    bad.blockable = Action{Action::Type::Coup, 0, 99};
+    CHECK_THROWS_AS(g.load(bad), IllegalAction);
+    bad.blockable.reset();
+    bad.pending = Action{Action::Type::Gather, 3, {}};
+    CHECK_THROWS_AS(g.load(bad), IllegalAction);
+    CHECK(g.turnIndex()==3);
+    CHECK(g.aliveCount()==14);
+    CHECK(ringOk());
+}
+
+TEST_CASE("24. Living view, isOver and winnerIndex") {
+    Game g;
+    Spy a(g,"A"), b(g,"B"), c(g,"C");
+    std::vector<Player*> ps{&a,&b,&c};
+    CHECK_FALSE(g.isOver());
+    CHECK_THROWS_AS(g.winnerIndex(), GameNotFinished);
+
+    a.addCoins(14);
+    advanceTo(g,ps,&a);
+    a.coup(b);
+    std::vector<std::size_t> seats;
+    std::vector<std::string> names;
+    const auto view = g.living();
+    for(auto it=view.begin(); it!=view.end(); ++it) seats.push_back(it.seat());
+    for(const Player& p : g.living()) names.push_back(p.name());
+    CHECK(view.size()==2);
+    CHECK(seats==std::vector<std::size_t>{0,2});
+    CHECK(names==g.players());
+
+    advanceTo(g,ps,&a);
+    a.coup(c);
+    CHECK(g.isOver());
+    CHECK(g.winnerIndex()==0);
+    CHECK(g.winner()=="A");
+    CHECK(g.living().begin()->name()=="A");
+}
+
+TEST_CASE("25. make / unmake restore the table exactly") {
+    Game g;
+    General gen(g,"G"); Judge jud(g,"J"); Governor gov(g,"V"); Merchant mer(g,"M");
+    for(Player* p : std::vector<Player*>{&gen,&jud,&gov,&mer}) p->addCoins(8);
+    std::size_t deltas = 0;
+    g.subscribe([&](const Delta&){ ++deltas; });
+
+    auto same = [&](const Game::State& s) {
+        const Game::State now = g.state();
+        for(std::size_t i=0;i<s.seats.size();++i) {
+            CHECK(now.seats[i].coins==s.seats[i].coins);
+            CHECK(now.seats[i].lastArrested==s.seats[i].lastArrested);
+            CHECK(now.seats[i].sanctionedUntil==s.seats[i].sanctionedUntil);
+            CHECK(now.seats[i].alive==s.seats[i].alive);
+        }
+        CHECK(now.turn==s.turn);
+        CHECK(now.tick==s.tick);
+        CHECK(now.blockable==s.blockable);
+        CHECK(now.blockableExpires==s.blockableExpires);
+    };
+    /* every action any seat could try right now, legal or not */
+    auto candidates = [&] {
+        std::vector<Action> out;
+        const std::size_t t = g.turnIndex();
+        for(auto type : {Action::Type::Gather, Action::Type::Tax, Action::Type::Bribe, Action::Type::Invest})
+            out.push_back({type, t, std::nullopt});
+        for(std::size_t v=0; v<g.roster().size(); ++v) {
+            for(auto type : {Action::Type::Arrest, Action::Type::Sanction, Action::Type::Coup})
+                out.push_back({type, t, v});
+            out.push_back({Action::Type::Block, v, std::nullopt});
+        }
+        return out;
+    };
+
+    std::size_t made = 0;
+    std::function<void(int)> dfs = [&](int depth) {
+        if(depth == 0 || g.isOver()) return;
+        const Game::State before = g.state();
+        std::vector<std::size_t> ring;
+        for(const Player& p : g.living()) ring.push_back(g.nextAlive(g.indexOf(p)));
+        for(const Action& a : candidates()) {
+            Game::UndoRecord u;
+            try { u = g.make(a); } catch(const std::exception&) { same(before); continue; }
+            ++made;
+            dfs(depth - 1);
+            g.unmake(u);
+            same(before);
+            CHECK(g.aliveCount()==ring.size());
+            std::size_t k = 0;
+            for(const Player& p : g.living()) CHECK(g.nextAlive(g.indexOf(p))==ring[k++]);
+        }
+    };
+    dfs(3);
+    CHECK(made > 100);
+    CHECK(deltas == 0);
+
+    g.perform({Action::Type::Gather, g.turnIndex(), std::nullopt});
+    CHECK(deltas == 1);                   // sinks are live again afterwards
+}
+
+TEST_CASE("26. performBatch is all-or-nothing and emits the net change") {
+    Game g;
+    Baron b(g,"B"); Judge j(g,"J"); Merchant m(g,"M"); Spy s(g,"S"); General gen(g,"G");
+    for(Player* p : std::vector<Player*>{&b,&j,&m,&s}) p->addCoins(5);
+    gen.addCoins(8);
+    DeltaStream stream;
+    g.subscribe(std::ref(stream));
+    using T = Action::Type;
+
+    /* Bribe and its extra action in one go */
+    const std::vector<Action> bribe{{T::Bribe,0,std::nullopt}, {T::Gather,0,std::nullopt}};
+    g.performBatch(bribe);
+    CHECK(b.coins()==2);
+    CHECK(g.turnIndex()==1);
+    CHECK(stream.count()==1);
+
+    /* the last action is illegal (only a General blocks a coup) → nothing changes */
+    const Game::State before = g.state();
+    const std::vector<Action> bad{{T::Arrest,1,2}, {T::Tax,2,std::nullopt}, {T::Gather,3,std::nullopt},
+                                  {T::Coup,4,0}, {T::Block,1,std::nullopt}};
+    CHECK_THROWS_AS(g.performBatch(bad), IllegalAction);
+    const Game::State after = g.state();
+    for(std::size_t i=0;i<5;++i){
+        CHECK(after.seats[i].coins==before.seats[i].coins);
+        CHECK(after.seats[i].alive==before.seats[i].alive);
+    }
+    CHECK(after.turn==before.turn);
+    CHECK(after.tick==before.tick);
+    CHECK(g.aliveCount()==5);
+    CHECK(stream.count()==1);
+
+    /* a whole round: more seats than one Delta holds, still replays exactly */
+    const std::vector<Action> round{{T::Arrest,1,2}, {T::Tax,2,std::nullopt}, {T::Sanction,3,0},
+                                    {T::Coup,4,1}, {T::Invest,0,std::nullopt}, {T::Tax,2,std::nullopt}};
+    g.performBatch(round);
+    CHECK_FALSE(g.alive(1));
+    CHECK(stream.count()>=2);
+    CHECK(stream.count()<=3);
+
+    std::vector<int>  coins{5,5,5,5,8};
+    std::vector<bool> alive(5,true);
+    std::size_t       turn = 0;
+    stream.replay([&](const Delta& d){
+        for(std::uint8_t i=0;i<d.nCoins;++i) coins[d.coins[i].seat] = int(d.coins[i].value);
+        if(d.died!=Delta::none)    alive[d.died]    = false;
+        if(d.revived!=Delta::none) alive[d.revived] = true;
+        if(d.turn!=Delta::none)    turn = d.turn;
+    });
+    for(std::size_t i=0;i<5;++i){
+        CHECK(coins[i]==g.roster()[i]->coins());
+        CHECK(alive[i]==g.alive(i));
+    }
+    CHECK(turn==g.turnIndex());
+}
+
+TEST_CASE("27. propose / commit applies blockable actions once") {
+    Game g;
+    Governor gov(g,"V"); General gen(g,"G"); Judge jud(g,"J"); Merchant m(g,"M");
+    for(Player* p : std::vector<Player*>{&gov,&gen,&jud,&m}) p->addCoins(8);
+    std::vector<Delta> seen;
+    g.subscribe([&](const Delta& d){ seen.push_back(d); });
+    using T = Action::Type;
+
+    /* proposed Tax, blocked by nobody → committed */
+    g.propose({T::Tax,0,std::nullopt});
+    CHECK(gov.coins()==8);
+    CHECK(seen.empty());
+    CHECK(g.blockable()==g.pending());
+    CHECK_THROWS_AS(g.perform({T::Gather,0,std::nullopt}), IllegalAction);
+    CHECK_THROWS_AS(g.propose({T::Tax,0,std::nullopt}), IllegalAction);
+    g.commit();
+    CHECK(gov.coins()==11);
+    CHECK(g.blockable()==nullptr);           // window closed with the commit
+    CHECK(g.turnIndex()==1);
+    CHECK(seen.size()==1);
+
+    gen.gather();
+
+    /* Judge's Coup on the Governor, blocked by the General: nobody dies or revives */
+    g.propose({T::Coup,2,0});
+    CHECK_THROWS_AS(g.block({T::Block,2,std::nullopt}), IllegalAction);   // own proposal
+    CHECK_THROWS_AS(g.block({T::Block,0,std::nullopt}), IllegalAction);   // only a General
+    seen.clear();
+    g.block({T::Block,1,std::nullopt});
+    CHECK(gen.coins()==4);
+    CHECK(jud.coins()==1);                   // 7 paid, as perform() then block() would
+    CHECK(g.alive(0));
+    REQUIRE(seen.size()==1);
+    CHECK(seen[0].died==Delta::none);
+    CHECK(seen[0].revived==Delta::none);
+    CHECK(seen[0].turn==3);                  // the blocked Coup still spent the turn
+
+    /* blocked Bribe: no coins move and the briber keeps the turn */
+    g.propose({T::Bribe,3,std::nullopt});
+    g.block({T::Block,2,std::nullopt});
+    CHECK(m.coins()==9);
+    CHECK(g.turnIndex()==3);
+    m.gather();
+
+    /* a General may block a coup aimed at themself; a committed coup kills once */
+    CHECK_THROWS_AS(g.propose({T::Tax,0,std::nullopt}), IllegalAction);   // 11 coins → coup
+    g.propose({T::Coup,0,1});
+    CHECK_THROWS_AS(g.block({T::Block,1,std::nullopt}), NotEnoughCoins);  // 4 coins
+    gen.addCoins(1);
+    g.block({T::Block,1,std::nullopt});
+    CHECK(gen.coins()==0);
+    CHECK(gov.coins()==4);                   // the blocked coup still cost 7
+    CHECK(g.turnIndex()==1);
+    gen.gather(); jud.gather();
+    m.spendCoins(2); m.gather();             // stay clear of the forced coup
+    gov.addCoins(3);
+    g.propose({T::Coup,0,1});
+    seen.clear();
+    g.commit();
+    CHECK_FALSE(g.alive(1));
+    CHECK(seen.size()==1);
+    CHECK_THROWS_AS(g.block({T::Block,1,std::nullopt}), IllegalAction);   // its window closed
+
+    /* make / unmake keep the proposal */
+    g.propose({T::Tax,2,std::nullopt});
+    const auto u = g.make({T::Block,0,std::nullopt});
+    CHECK(g.pending()==nullptr);
+    CHECK(g.turnIndex()==3);
+    g.unmake(u);
+    REQUIRE(g.pending()!=nullptr);
+    CHECK(g.turnIndex()==2);
+    g.commit();
+    CHECK(jud.coins()==4);
+
+    /* a commit the table no longer allows drops the proposal; the turn stays */
+    g.propose({T::Coup,3,2});
+    for(int k=0;k<3;++k) g.governorUndoTax(gov, m);   // 11 → 5 coins
+    CHECK_THROWS_AS(g.commit(), NotEnoughCoins);
+    CHECK(g.pending()==nullptr);
+    CHECK(g.turnIndex()==3);
+    m.gather();
+    CHECK(m.coins()==6);
+}
+
+TEST_CASE("28. Names are interned once; turns are asked by seat") {
+    Game g;
+    Governor a(g,"Alice"); Spy b(g,"Bob"); Judge c(g,"Alice");
+    const std::string& first = a.name();
+    CHECK(g.names().size()==2);                   // "Alice" twice, stored once
+    CHECK(g.nameId(0)==g.nameId(2));
+    CHECK(g.nameId(0)!=g.nameId(1));
+    CHECK(g.names().find("Bob")==g.nameId(1));
+    CHECK(g.names().find("Carol")==NameTable::none);
+    CHECK(g.nameOf(1)=="Bob");
+
+    std::vector<std::unique_ptr<Player>> more;
+    for(int i=0;i<100;++i) more.push_back(std::make_unique<Merchant>(g,"M"+std::to_string(i)));
+    CHECK(&first==&a.name());                     // growing the table moves nothing
+    CHECK(first=="Alice");
+
+    /* same name, different seats: only the seat says whose turn it is */
+    Game h;
+    Governor x(h,"Twin"); Baron y(h,"Twin");
+    x.gather();
+    CHECK(h.turnIndex()==y.seat());
+    CHECK(h.turn()=="Twin");
+    CHECK_THROWS_AS(x.gather(), NotYourTurn);
+    y.gather();
+    CHECK(h.turnIndex()==x.seat());
+}
+
+TEST_CASE("29. ActionCode packs an Action into 16 bits") {
+    using T = Action::Type;
+    constexpr ActionCode coup(Action{T::Coup, 5, 62});
+    static_assert(sizeof(ActionCode)==2);
+    static_assert(coup.type()==T::Coup && coup.actor()==5 && coup.target()==62);
+    static_assert(coup.decode()==Action{T::Coup, 5, 62});
+    static_assert(!ActionCode(Action{T::Gather, 62, {}}).hasTarget());
+    static_assert(ActionCode(Action{T::Tax, 1, {}}) != ActionCode(Action{T::Tax, 1, 0}));
+    CHECK_THROWS_AS(ActionCode(Action{T::Gather, 63, {}}), std::out_of_range);
+    CHECK_THROWS_AS(ActionCode(Action{T::Arrest, 0, 63}), std::out_of_range);
+
+    for(int t=0;t<=static_cast<int>(T::SpyPeek);++t)
+        for(std::size_t a=0;a<ActionCode::kMaxSeats;a+=7) {
+            const Action with{static_cast<T>(t), a, (a*5)%ActionCode::kMaxSeats};
+            const Action without{static_cast<T>(t), a, {}};
+            CHECK(ActionCode(with).decode()==with);
+            CHECK(ActionCode(without).decode()==without);
+            CHECK(ActionCode::fromBits(ActionCode(with).bits())==ActionCode(with));
+        }
+
+    /* perform / block take codes directly */
+    Game g;
+    Governor gov(g,"G"); Baron bar(g,"B");
+    g.perform(ActionCode(Action{T::Tax, 0, {}}));
+    CHECK(gov.coins()==3);
+    bar.addCoins(3);
+    CHECK_THROWS_AS(g.perform(ActionCode(Action{T::Tax, 0, {}})), NotYourTurn);
+    g.perform(ActionCode(Action{T::Invest, 1, {}}));
+    CHECK(bar.coins()==6);
+    g.perform(ActionCode(Action{T::Tax, 0, {}}));
+    CHECK_THROWS_AS(g.block(ActionCode(Action{T::Block, 0, {}})), IllegalAction);   // own Tax
+    CHECK(gov.coins()==6);
+}
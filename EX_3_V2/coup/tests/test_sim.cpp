@@ -0,0 +1,824 @@
+// thelet.shevach@gmail.com
+#include "doctest.h"
+
+#include "sim/Analytics.hpp"
+#include "sim/Archive.hpp"
+#include "sim/Bitmap.hpp"
+#include "sim/Cfr.hpp"
+#include "sim/Eval.hpp"
+#include "sim/Executor.hpp"
+#include "sim/GameIndex.hpp"
+#include "sim/Ismcts.hpp"
+#include "sim/MoveGen.hpp"
+#include "sim/Perft.hpp"
+#include "sim/Rating.hpp"
+#include "sim/Scheduler.hpp"
+#include "sim/SelfPlay.hpp"
+#include "sim/Snapshot.hpp"
+#include "sim/Simulator.hpp"
+#include "sim/Table.hpp"
+#include "sim/TimingWheel.hpp"
+
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <string>
+#include <set>
+#include <thread>
+#include <vector>
+using namespace coup_sim;
+
+TEST_CASE("S1. Generated moves are always accepted by the engine") {
+    RandomBot rnd(0.5);
+    for(std::uint64_t seed=1; seed<=200; ++seed) {
+        Rng rng(seed);
+        std::vector<Role> roles;
+        for(std::size_t i=0;i<2+seed%5;++i) roles.push_back(static_cast<Role>(rng.below(kRoleCount)));
+        Table t = Table::deal(roles);
+        std::vector<Bot*> bots(roles.size(), &rnd);
+        GameResult r;
+        CHECK_NOTHROW(r = playGame(*t.game, bots, rng, 500));
+        if(r.winner != GameResult::noWinner) CHECK(aliveCount(*t.game)==1);
+    }
+
+    /* the 16-bit move lists are the same moves, in the same order */
+    std::vector<coup::Action>     moves;
+    std::vector<coup::ActionCode> codes;
+    for(std::uint64_t seed=1; seed<=30; ++seed) {
+        Rng rng(seed);
+        std::vector<Role> roles;
+        for(std::size_t i=0;i<2+seed%5;++i) roles.push_back(static_cast<Role>(rng.below(kRoleCount)));
+        Table t = Table::deal(roles);
+        for(int step=0; step<100 && !t.game->isOver(); ++step) {
+            moves.clear(); codes.clear();
+            if(rng.below(3)==0) { legalBlocks(*t.game, moves); legalBlocks(*t.game, codes); }
+            if(moves.empty())   { legalMoves (*t.game, moves); legalMoves (*t.game, codes); }
+            REQUIRE(codes.size()==moves.size());
+            if(moves.empty()) break;
+            CHECK(std::equal(codes.begin(), codes.end(), moves.begin(),
+                             [](coup::ActionCode c, const coup::Action& m){ return c.decode()==m; }));
+            CHECK_NOTHROW(apply(*t.game, codes[rng.below(codes.size())]));
+        }
+    }
+}
+
+TEST_CASE("S2. Balance study does not depend on the thread count") {
+    StudyConfig cfg;
+    cfg.games = 600;
+    cfg.seed  = 7;
+    cfg.threads = 1;
+    const BalanceStats one = runBalanceStudy(cfg);
+    cfg.threads = 3;
+    const BalanceStats three = runBalanceStudy(cfg);
+
+    CHECK(one.games==600);
+    CHECK(three.games==600);
+    CHECK(one.wins==three.wins);
+    CHECK(one.blocks==three.blocks);
+    CHECK(one.ticksSum==three.ticksSum);
+    CHECK(one.tickHist==three.tickHist);
+}
+
+TEST_CASE("S3. Columnar file round-trips every game") {
+    const std::string path = "/tmp/coup_test_games.col";
+    StudyConfig cfg;
+    cfg.games   = RowGroup::kRows + 100;          // at least two row groups
+    cfg.threads = 2;
+    BalanceStats s;
+    {
+        ColumnarWriter out(path);
+        s = runBalanceStudy(cfg, &out);
+    }
+    ColumnarReader in(path);
+    RowGroup g;
+    BalanceStats back;
+    std::uint64_t rows = 0;
+    while(in.next(g)) {
+        for(std::size_t i=0;i<g.size();++i) back.add(g.row(i));
+        rows += g.size();
+    }
+    CHECK(rows==cfg.games);
+    CHECK(back.wins==s.wins);
+    CHECK(back.ticksSum==s.ticksSum);
+
+    /* rows naming a role or seat that cannot exist are refused */
+    GameRecord bad = g.row(0);
+    bad.seatRoles = (bad.seatRoles & ~0xFull) | kRoleCount;
+    {
+        ColumnarWriter out(path);
+        RowGroup one;
+        one.push(bad);
+        out.write(one);
+    }
+    ColumnarReader badIn(path);
+    CHECK_THROWS_AS(badIn.next(g), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+/* collects the study's games as records, for the rating tests */
+static std::vector<GameRecord> simulatedGames(std::uint64_t n) {
+    const std::string path = "/tmp/coup_test_rating.col";
+    StudyConfig cfg;
+    cfg.games = n;
+    { ColumnarWriter out(path); runBalanceStudy(cfg, &out); }
+    std::vector<GameRecord> recs;
+    ColumnarReader in(path);
+    RowGroup g;
+    while(in.next(g)) for(std::size_t i=0;i<g.size();++i) recs.push_back(g.row(i));
+    std::remove(path.c_str());
+    return recs;
+}
+
+TEST_CASE("S4. Greedy bot out-rates random; threads do not change batched Elo") {
+    const auto games = simulatedGames(3000);
+    RatingConfig cfg;
+    cfg.threads = 1;
+    RatingEngine one(2, cfg);
+    cfg.threads = 4;
+    RatingEngine four(2, cfg);
+    for(std::size_t i=0;i<games.size();i+=500) {
+        std::vector<GameRecord> batch(games.begin()+i, games.begin()+std::min(games.size(), i+500));
+        one.update(batch);
+        four.update(batch);
+    }
+    CHECK(one.gamesSeen()==games.size());
+    CHECK(one.bots().mu[1] > one.bots().mu[0]);                 // greedy > random
+    for(std::size_t i=0;i<2;++i)          CHECK(four.bots().mu[i]  == doctest::Approx(one.bots().mu[i]));
+    for(std::size_t r=0;r<kRoleCount;++r) CHECK(four.roles().mu[r] == doctest::Approx(one.roles().mu[r]));
+
+    /* out-of-range bots and winners are refused before anything is scored */
+    GameRecord bot = games.front(), winner = games.front();
+    bot.seatBots      = (bot.seatBots & ~0xFull) | 2;              // 2 bots rated: 0 and 1
+    winner.winnerSeat = winner.players;
+    CHECK_THROWS_AS(one.update({bot}),    std::invalid_argument);
+    CHECK_THROWS_AS(one.update({winner}), std::invalid_argument);
+    CHECK(one.gamesSeen()==games.size());
+}
+
+TEST_CASE("S5. TrueSkill checkpoint restores the exact state") {
+    const auto games = simulatedGames(500);
+    RatingConfig cfg;
+    cfg.model = RatingModel::TrueSkill;
+    RatingEngine a(2, cfg);
+    a.update(games);
+    CHECK(a.bots().sigma2[1] < cfg.sigma0*cfg.sigma0);
+    a.saveCheckpoint("/tmp/coup_test.ckpt");
+
+    RatingEngine b(2, cfg);
+    b.loadCheckpoint("/tmp/coup_test.ckpt");
+    CHECK(b.gamesSeen()==a.gamesSeen());
+    CHECK(b.bots().mu==a.bots().mu);
+    CHECK(b.roles().sigma2==a.roles().sigma2);
+
+    RatingEngine elo(2, RatingConfig{});
+    CHECK_THROWS_AS(elo.loadCheckpoint("/tmp/coup_test.ckpt"), std::runtime_error);
+    std::remove("/tmp/coup_test.ckpt");
+}
+
+TEST_CASE("S6. Observations hide other players' coins unless peeked") {
+    Table t = Table::deal({Role::Spy, Role::Baron, Role::Merchant});
+    coup::Game& g = *t.game;
+    t.seats[0]->addCoins(2);
+    t.seats[1]->addCoins(5);
+    t.seats[2]->addCoins(8);
+    CHECK(static_cast<coup::Spy&>(*t.seats[0]).peek(*t.seats[1])==5);
+
+    const Observation o = observe(g, 0);
+    CHECK(o.state.seats[0].coins==2);
+    CHECK(o.state.seats[1].coins==kHiddenCoins);
+    CHECK(o.state.seats[2].coins==kHiddenCoins);
+    CHECK(o.peeked[1]==5);
+    CHECK(observe(g, 1).peeked[0]==kHiddenCoins);          // peeks are private
+
+    Rng rng(3);
+    for(int i=0;i<50;++i) {
+        const coup::Game::State d = determinize(o, rng);
+        CHECK(d.seats[0].coins==2);
+        CHECK(d.seats[1].coins==5);                           // peeked this tick
+        CHECK(d.seats[2].coins>=0);
+        CHECK(d.seats[2].coins<=9);
+    }
+}
+
+TEST_CASE("S7. ISMCTS takes the winning coup on every thread count") {
+    for(unsigned threads : {1u, 3u}) {
+        Table t = Table::deal({Role::Spy, Role::Spy});
+        t.seats[0]->addCoins(7);
+        std::vector<coup::Action> moves;
+        legalMoves(*t.game, moves);
+        IsmctsConfig cfg;
+        cfg.threads    = threads;
+        cfg.iterations = 300;
+        const coup::Action a = ismctsSearch(observe(*t.game, 0), moves, cfg, 11);
+        CHECK(a.type==coup::Action::Type::Coup);
+        CHECK(a.target==std::optional<std::size_t>(1));
+    }
+
+    /* a Merchant's hidden 1 or 2 coins decide whether Arrest is legal; the
+       search must not learn that from the move list, so it runs the same */
+    Table poor = Table::deal({Role::Spy, Role::Merchant, Role::Spy});
+    Table rich = Table::deal({Role::Spy, Role::Merchant, Role::Spy});
+    rich.seats[1]->addCoins(1);
+    for(std::size_t s=0;s<3;++s) { poor.seats[s]->gather(); rich.seats[s]->gather(); }   // 2+ coins plausible
+    std::vector<coup::Action> poorMoves, richMoves;
+    legalMoves(*poor.game, poorMoves);
+    legalMoves(*rich.game, richMoves);
+    REQUIRE(richMoves.size()==poorMoves.size()+1);
+    IsmctsConfig cfg;
+    cfg.iterations = 150;
+    cfg.budgetMs   = 1e6;
+    const coup::Action arrest{coup::Action::Type::Arrest, 0, 1};
+    for(std::uint64_t seed=1; seed<=8; ++seed) {
+        const coup::Action p = ismctsSearch(observe(*poor.game, 0), poorMoves, cfg, seed);
+        const coup::Action r = ismctsSearch(observe(*rich.game, 0), richMoves, cfg, seed);
+        CHECK(p!=arrest);
+        if(r!=arrest) CHECK(p==r);
+    }
+
+    /* the reaction is searched too: a General buys back its own life */
+    Table duel = Table::deal({Role::Spy, Role::General});
+    duel.seats[0]->addCoins(7);
+    duel.seats[1]->addCoins(5);
+    duel.game->propose({coup::Action::Type::Coup, 0, 1});
+    IsmctsBot bot(cfg);
+    Rng rng(7);
+    for(int k=0;k<4;++k) CHECK(bot.react(*duel.game, 1, rng));
+    /* but does not pay 5 to keep a rival alive */
+    Table three = Table::deal({Role::Spy, Role::General, Role::Spy});
+    three.seats[0]->addCoins(7);
+    three.seats[1]->addCoins(5);
+    three.game->propose({coup::Action::Type::Coup, 0, 2});
+    for(int k=0;k<4;++k) CHECK_FALSE(bot.react(*three.game, 1, rng));
+}
+
+TEST_CASE("S8. CFR trainer writes a reaction table bots can load") {
+    CfrConfig cfg;
+    cfg.threads  = 2;
+    cfg.windows  = 200;
+    cfg.rollouts = 1;
+    cfg.epoch    = 16;
+    CfrTrainer trainer(cfg);
+    trainer.train();
+    const ReactionTable table = trainer.averageStrategy();
+
+    std::uint64_t visited = 0;
+    for(std::size_t k=0;k<kReactionKeys;++k) visited += trainer.visits(static_cast<std::uint16_t>(k));
+    CHECK(visited>=cfg.windows);
+
+    table.save("/tmp/coup_test.cfr");
+    ReactionTable back;
+    back.load("/tmp/coup_test.cfr");
+    std::remove("/tmp/coup_test.cfr");
+    for(std::size_t k=0;k<kReactionKeys;++k)
+        CHECK(back.blockProb(static_cast<std::uint16_t>(k))==table.blockProb(static_cast<std::uint16_t>(k)));
+
+    /* the coup victim is bit 11 of the key */
+    Table t = Table::deal({Role::Spy, Role::General, Role::Spy});
+    t.seats[0]->addCoins(7);
+    t.seats[1]->addCoins(5);
+    t.seats[0]->coup(*t.seats[1]);
+    CHECK(canBlock(*t.game, 1));
+    CHECK((reactionKey(*t.game, 1) >> 11)==1);
+
+    cfg.epoch = 0;
+    CHECK_THROWS_AS(CfrTrainer{cfg}, std::invalid_argument);
+
+    GreedyBot greedy;
+    CfrBot bot(greedy, back);
+    Rng rng(5);
+    std::vector<Bot*> bots{&bot, &bot, &bot};
+    Table game = Table::deal({Role::Governor, Role::Judge, Role::General});
+    CHECK_NOTHROW(playGame(*game.game, bots, rng, 500));
+}
+
+TEST_CASE("S9. Batched evaluation matches the scalar reference") {
+    Table t = Table::deal({Role::Governor, Role::Spy, Role::Baron, Role::Judge});
+    t.seats[0]->addCoins(4);
+    t.seats[1]->addCoins(2);
+
+    FeatureBatch batch(4);
+    for(std::size_t i=0;i<4;++i) extractFeatures(*t.game, i, batch.push());
+    CHECK(batch.full());
+    const float* me = batch.row(0);
+    CHECK(me[0]==1.0f);
+    CHECK(me[1]==doctest::Approx(0.4));
+    CHECK(me[2 + std::size_t(Role::Governor)]==1.0f);
+    CHECK(batch.row(1)[kSeatFeatures + 1]==doctest::Approx(0.0));   // seat 2 seen from seat 1
+
+    for(auto kind : {EvalModel::Kind::Linear, EvalModel::Kind::Mlp}) {
+        EvalModel m(kind);
+        Rng rng(3);
+        m.randomize(rng, 0.5f);
+        float fast[4], slow[4];
+        m.evaluate(batch.data(), 4, fast);
+        m.evaluateScalar(batch.data(), 4, slow);
+        for(std::size_t i=0;i<4;++i) {
+            CHECK(fast[i]==doctest::Approx(slow[i]).epsilon(1e-5));
+            CHECK(fast[i]>0.0f);
+            CHECK(fast[i]<1.0f);
+        }
+
+        m.save("/tmp/coup_test.evl");
+        EvalModel back;
+        back.load("/tmp/coup_test.evl");
+        std::remove("/tmp/coup_test.evl");
+        CHECK(back.kind()==kind);
+        CHECK(back.evaluate1(batch.row(2))==m.evaluate1(batch.row(2)));
+    }
+
+    /* the model can stand in for the coin-share heuristic */
+    EvalModel m;
+    Table w = Table::deal({Role::Spy, Role::Spy});
+    w.seats[0]->addCoins(7);
+    std::vector<coup::Action> moves;
+    legalMoves(*w.game, moves);
+    IsmctsConfig cfg;
+    cfg.iterations = 300;
+    cfg.eval       = &m;
+    CHECK(ismctsSearch(observe(*w.game, 0), moves, cfg, 11).type==coup::Action::Type::Coup);
+}
+
+TEST_CASE("S10. Replay buffer survives reopening; self-play learns while acting") {
+    const std::string path = "/tmp/coup_test.rpl";
+    std::remove(path.c_str());
+    {
+        ReplayBuffer buf(path, 8);
+        FeatureBatch rows(10);
+        float labels[10];
+        for(std::size_t i=0;i<10;++i) { std::fill(rows.push(), rows.row(i) + kFeatures, float(i)); labels[i] = float(i); }
+        buf.append(rows.data(), labels, 10);
+        CHECK(buf.written()==10);
+        CHECK(buf.size()==8);
+    }
+    {
+        ReplayBuffer buf(path, 8);
+        CHECK(buf.written()==10);
+        FeatureBatch got(32);
+        float labels[32];
+        Rng rng(1);
+        REQUIRE(buf.sample(rng, 32, got, labels));
+        for(std::size_t i=0;i<32;++i) {
+            CHECK(labels[i]>=2.0f);                       // 0 and 1 were overwritten
+            CHECK(got.row(i)[kFeatures-1]==labels[i]);
+        }
+    }
+    CHECK(ReplayBuffer(path, 16).written()==0);           // other shape → starts over
+
+    SelfPlayConfig cfg;
+    cfg.games    = 40;
+    cfg.steps    = 50;
+    cfg.batch    = 16;
+    cfg.warmup   = 64;
+    cfg.buffer   = path;
+    cfg.capacity = 4096;
+    cfg.maxPlayers = 4;
+    SelfPlayTrainer trainer(cfg);
+    const SelfPlayStats st = trainer.train();
+    cfg.publishEvery = 0;
+    CHECK_THROWS_AS(SelfPlayTrainer{cfg}, std::invalid_argument);
+    std::remove(path.c_str());
+
+    /* a buffer that cannot be written fails train(), not the process */
+    cfg.publishEvery = 1;
+    cfg.buffer       = "/dev/full";
+    SelfPlayTrainer full(cfg);
+    CHECK_THROWS_AS(full.train(), std::runtime_error);
+    CHECK(st.games==40);
+    CHECK(st.samples>0);
+    CHECK(st.steps>=50);
+    CHECK(std::isfinite(st.loss));
+
+    auto model = std::make_shared<const EvalModel>(trainer.model());
+    EvalBot bot(model);
+    Rng rng(2);
+    std::vector<Bot*> bots{&bot, &bot, &bot};
+    Table t = Table::deal({Role::Baron, Role::Judge, Role::General});
+    CHECK_NOTHROW(playGame(*t.game, bots, rng, 500));
+}
+
+TEST_CASE("S11. Snapshot plus action tail recovers every table exactly") {
+    const std::string snap = "/tmp/coup_test.snp", tail = "/tmp/coup_test.tal";
+    std::remove(snap.c_str());
+    std::remove(tail.c_str());
+
+    Rng rng(11);
+    std::vector<Table> live;
+    for(std::size_t i=0;i<40;++i) {
+        std::vector<Role> roles;
+        for(std::size_t k=0;k<2+i%5;++k) roles.push_back(static_cast<Role>(rng.below(kRoleCount)));
+        live.push_back(Table::deal(roles));
+    }
+    std::vector<coup::Action> moves;
+    std::uint64_t appended = 0;
+    auto play = [&](ActionTail& log, std::size_t steps) {
+        for(std::size_t n=0;n<steps;++n) {
+            const std::size_t i = rng.below(live.size());
+            coup::Game& g = *live[i].game;
+            const auto id = static_cast<std::uint32_t>(i);
+            moves.clear();
+            if(g.pending() || rng.below(4)==0) legalBlocks(g, moves);
+            if(g.pending() && (moves.empty() || rng.below(2)==0)) {
+                log.append(id, *g.pending(), TailOp::Commit);
+                try { g.commit(); } catch(const std::exception&) {}
+                continue;
+            }
+            if(moves.empty()) legalMoves(g, moves);
+            if(moves.empty()) continue;
+            const coup::Action a = moves[rng.below(moves.size())];
+            const bool twoPhase = a.type==coup::Action::Type::Tax || a.type==coup::Action::Type::Bribe
+                               || a.type==coup::Action::Type::Coup;
+            if(twoPhase && rng.below(3)==0) {
+                g.propose(a);
+                log.append(id, a, TailOp::Propose);
+            } else {
+                apply(g, a);
+                log.append(id, a);
+            }
+        }
+    };
+    auto same = [](const coup::Game::State& a, const coup::Game::State& b) {
+        REQUIRE(a.seats.size()==b.seats.size());
+        for(std::size_t k=0;k<a.seats.size();++k) {
+            CHECK(a.seats[k].coins==b.seats[k].coins);
+            CHECK(a.seats[k].lastArrested==b.seats[k].lastArrested);
+            CHECK(a.seats[k].sanctionedUntil==b.seats[k].sanctionedUntil);
+            CHECK(a.seats[k].alive==b.seats[k].alive);
+        }
+        CHECK(a.turn==b.turn);
+        CHECK(a.tick==b.tick);
+        CHECK(a.blockable==b.blockable);
+        if(a.blockable) CHECK(a.blockableExpires==b.blockableExpires);
+        CHECK(a.pending==b.pending);
+    };
+
+    {
+        ActionTail log(tail);
+        play(log, 600);
+        std::vector<const Table*> all;
+        for(const Table& t : live) all.push_back(&t);
+        saveSnapshot(snap, all, log.records());
+        std::size_t open = 0;
+        for(const Table& t : live)
+            if(t.game->pending()) { ++open; same(t.copy().game->state(), t.game->state()); }
+        CHECK(open > 0);                                  // proposals cross the snapshot
+        play(log, 300);                                   // after the snapshot
+        log.sync();
+        appended = log.records();
+    }
+    {
+        std::FILE* f = std::fopen(tail.c_str(), "ab");    // a torn final append
+        std::fputs("torn", f);
+        std::fclose(f);
+    }
+
+    const std::vector<Table> back = recover(snap, tail);
+    REQUIRE(back.size()==live.size());
+    for(std::size_t i=0;i<live.size();++i) {
+        CHECK(roleOf(*back[i].seats.front())==roleOf(*live[i].seats.front()));
+        same(back[i].game->state(), live[i].game->state());
+        CHECK(back[i].game->aliveCount()==live[i].game->aliveCount());
+    }
+    CHECK(ActionTail(tail).records()==appended);          // torn bytes dropped
+
+    {
+        std::FILE* f = std::fopen(snap.c_str(), "r+b");   // flip one payload byte
+        std::fseek(f, 50, SEEK_SET);
+        const int c = std::fgetc(f);
+        std::fseek(f, 50, SEEK_SET);
+        std::fputc(c ^ 1, f);
+        std::fclose(f);
+    }
+    CHECK_THROWS_AS(SnapshotFile{snap}, std::runtime_error);
+    std::remove(snap.c_str());
+    std::remove(tail.c_str());
+}
+
+TEST_CASE("S12. Table executor runs each table's commands in posting order") {
+    TableExecutor ex(64);
+    constexpr std::size_t kTables = 50, kProducers = 4, kPerProducer = 2000;
+    for(std::size_t i=0;i<kTables;++i) ex.adopt(Table::deal({Role::Spy, Role::Baron, Role::Judge}));
+
+    /* before start(): mail waits, a full inbox says so */
+    TableExecutor small(2);
+    small.adopt(Table::deal({Role::Spy, Role::Baron}));
+    CHECK(small.post(0, [](coup::Game&){}));
+    CHECK(small.post(0, [](coup::Game&){}));
+    CHECK_FALSE(small.post(0, [](coup::Game&){}));
+    CHECK_THROWS_AS(small.query(0, [](const coup::Game& g){ return g.tick(); }).get(), std::runtime_error);
+    CHECK(small.run()==2);
+
+    /* last sequence number seen per (table, producer) – executor-only state */
+    std::vector<std::vector<long>> last(kTables, std::vector<long>(kProducers, -1));
+    std::atomic<std::size_t> outOfOrder{0}, ran{0};
+    ex.start();
+    std::vector<std::thread> producers;
+    for(std::size_t p=0;p<kProducers;++p)
+        producers.emplace_back([&, p] {
+            for(std::size_t k=0;k<kPerProducer;++k) {
+                const std::size_t t = (k * 7 + p) % kTables;
+                auto cmd = [&, t, p, k](coup::Game&) {
+                    if(last[t][p] >= long(k)) ++outOfOrder;
+                    last[t][p] = long(k);
+                    ++ran;
+                };
+                while(!ex.post(t, cmd)) std::this_thread::yield();   // back-pressure
+            }
+        });
+    for(auto& th : producers) th.join();
+
+    /* engine calls and queries through futures */
+    CHECK_NOTHROW(ex.perform(3, {coup::Action::Type::Gather, 0, std::nullopt}).get());
+    CHECK_THROWS_AS(ex.perform(3, {coup::Action::Type::Gather, 0, std::nullopt}).get(), coup::NotYourTurn);
+    CHECK(ex.query(3, [](const coup::Game& g){ return g.turn(); }).get()=="P2");
+    CHECK(ex.query(3, [](const coup::Game& g){ return g.players().size(); }).get()==3);
+    ex.stop();
+
+    CHECK(ran==kProducers*kPerProducer);
+    CHECK(outOfOrder==0);
+    CHECK(ex.table(3).game->turnIndex()==1);
+}
+
+TEST_CASE("S13. Scheduler shards tables and rebalances them by load") {
+    SchedulerConfig cfg;
+    cfg.workers = 3;
+    Scheduler sched(cfg);
+    for(std::size_t i=0;i<12;++i)
+        sched.add([] { return Table::deal({Role::Merchant, Role::General, Role::Spy}); });
+    CHECK(sched.workerOf(4)==1);
+    sched.start();
+
+    /* only worker 0's tables get traffic */
+    std::vector<std::size_t> hot;
+    for(std::size_t id=0; id<sched.size(); ++id) if(sched.workerOf(id)==0) hot.push_back(id);
+    for(std::size_t round=0; round<3; ++round)
+        for(std::size_t id : hot) {
+            const std::size_t turn = sched.query(id, [](const coup::Game& g){ return g.turnIndex(); }).get();
+            sched.perform(id, {coup::Action::Type::Gather, turn, std::nullopt}).get();
+        }
+    sched.stop();
+    std::vector<std::uint64_t> before = sched.load();
+    CHECK(before[0] > 0);
+    CHECK(before[1]+before[2]==0);
+
+    const std::size_t moved = sched.rebalance();
+    CHECK(moved >= 2);
+    std::size_t elsewhere = 0;
+    for(std::size_t id : hot) elsewhere += sched.workerOf(id)!=0;
+    CHECK(elsewhere==moved);
+
+    /* moved tables kept their state and still take commands */
+    sched.start();
+    for(std::size_t id : hot) {
+        CHECK(sched.query(id, [](const coup::Game& g){ return g.tick(); }).get()==3);
+        CHECK(sched.query(id, [](const coup::Game& g){ return g.roster()[0]->name(); }).get()=="P1");
+        CHECK_NOTHROW(sched.perform(id, {coup::Action::Type::Gather, 0, std::nullopt}).get());
+    }
+    sched.stop();
+    CHECK(sched.load()[0] < before[0]);
+}
+
+TEST_CASE("S14. Timing wheel fires each timer exactly once, on its tick") {
+    std::vector<std::uint64_t> due, firedAt;
+    std::size_t early = 0;
+    TimingWheel* self = nullptr;
+    TimingWheel wheel([&](std::uint64_t k) {
+        firedAt[k] = self->now();
+        if(self->now() != due[k]) ++early;
+    });
+    self = &wheel;
+
+    Rng rng(14);
+    std::vector<TimingWheel::TimerId> ids;
+    for(std::size_t k=0;k<3000;++k) {
+        const std::uint64_t delay = 1 + rng.below(k%3==0 ? 200000 : 700);
+        due.push_back(wheel.now() + delay);
+        firedAt.push_back(0);
+        ids.push_back(wheel.schedule(delay, k));
+        if(k%50==0) wheel.advance(rng.below(300));        // schedule from a moving clock
+    }
+    std::size_t cancelled = 0;
+    for(std::size_t k=0;k<ids.size();k+=4) cancelled += wheel.cancel(ids[k]);
+    CHECK_FALSE(wheel.cancel(ids[0]));                     // twice
+    wheel.advance(300000);
+    CHECK(wheel.size()==0);
+    CHECK(early==0);
+    std::size_t fired = 0;
+    for(std::size_t k=0;k<ids.size();++k) fired += firedAt[k]!=0;
+    CHECK(fired + cancelled == ids.size());
+
+    /* the executor's turn clock: idle turns auto-gather, proposals auto-commit */
+    TableExecutor ex(16);
+    ex.adopt(Table::deal({Role::Spy, Role::Baron}));
+    ex.adopt(Table::deal({Role::Spy, Role::Judge}));
+    ex.setTimers({std::chrono::milliseconds(100), std::chrono::milliseconds(50), std::chrono::milliseconds(10)});
+    CHECK(ex.advanceClock(std::chrono::milliseconds(90))==0);
+    ex.post(1, [](coup::Game& g){ g.perform({coup::Action::Type::Gather, 0, std::nullopt}); });
+    ex.run();                                             // table 1 moved: its clock restarts
+    CHECK(ex.advanceClock(std::chrono::milliseconds(10))==1);
+    CHECK(ex.table(0).game->tick()==1);
+    CHECK(ex.table(1).game->tick()==1);
+    ex.post(1, [](coup::Game& g){ g.propose({coup::Action::Type::Tax, 1, std::nullopt}); });
+    ex.run();
+    CHECK(ex.advanceClock(std::chrono::milliseconds(50))==1);   // reaction window ran out
+    CHECK(ex.table(1).game->pending()==nullptr);
+    CHECK(ex.table(1).seats[1]->coins()==2);               // the Judge's Tax
+    CHECK(ex.timeouts()==2);
+
+    /* on the executor thread, against the steady clock */
+    ex.setTimers({std::chrono::milliseconds(5), std::chrono::milliseconds(5), std::chrono::milliseconds(1)});
+    ex.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ex.stop();
+    CHECK(ex.timeouts() > 5);
+}
+
+TEST_CASE("S15. Replay archive holds every game of a study, move by move") {
+    const std::string path = "/tmp/coup_test.arc";
+    StudyConfig cfg;
+    cfg.games   = 700;
+    cfg.threads = 3;
+    cfg.seed    = 15;
+    BalanceStats stats;
+    {
+        ArchiveWriter arc(path);
+        stats = runBalanceStudy(cfg, nullptr, &arc);
+        arc.close();
+    }
+
+    ArchiveReader r(path);
+    CHECK(r.games()  == cfg.games);
+    CHECK(r.blocks() == 3);                                // 256-id chunks
+
+    std::uint64_t next = 0, draws = 0, actions = 0;
+    r.scan([&](const ArchivedGame& g) {
+        CHECK(g.id == next++);
+        actions += g.actions.size();
+        if(g.winner == GameResult::noWinner) { ++draws; return; }
+        /* the moves rebuild the game and its winner */
+        Table t = Table::deal(g.roles);
+        replayGame(*t.game, g.actions);
+        CHECK(t.game->isOver());
+        CHECK(t.game->winnerIndex() == g.winner);
+    });
+    CHECK(next  == cfg.games);
+    CHECK(draws == stats.draws);
+    CHECK(double(r.bytes()) * 8 / double(actions) < 12.0);
+
+    ArchivedGame one, again;
+    REQUIRE(r.find(431, one));
+    r.scan([&](const ArchivedGame& g){ if(g.id == 431) again = g; });
+    CHECK(one.roles   == again.roles);
+    CHECK(one.winner  == again.winner);
+    CHECK(one.actions == again.actions);
+    CHECK_FALSE(r.find(cfg.games, one));
+
+    /* add() cuts blocks itself and refuses ids out of order */
+    {
+        ArchiveWriter arc(path, 4);
+        for(std::uint64_t id=10; id<30; id+=2) arc.add({id, {Role::Spy, Role::Judge}, 1,
+                                                        {{coup::Action::Type::Coup, 1, 0}}});
+        CHECK_THROWS_AS(arc.add({12, {Role::Spy, Role::Judge}, 0, {}}), std::invalid_argument);
+    }
+    ArchiveReader small(path);
+    CHECK(small.blocks() == 3);
+    CHECK(small.find(28, one));
+    CHECK(one.actions.size() == 1);
+    CHECK(*one.actions[0].target == 0);
+    CHECK_FALSE(small.find(13, one));
+    CHECK_FALSE(small.find(9, one));
+
+    /* a corrupt game throws instead of decoding past its block: the first
+       block starts at byte 8 – games, id delta, players, roles, ...      */
+    auto corrupt = [&](long at, int byte) {
+        std::FILE* f = std::fopen(path.c_str(), "r+b");
+        std::fseek(f, at, SEEK_SET);
+        const int was = std::fgetc(f);
+        std::fseek(f, at, SEEK_SET);
+        std::fputc(byte, f);
+        std::fclose(f);
+        return was;
+    };
+    const int players = corrupt(10, 40);
+    CHECK_THROWS_AS(ArchiveReader(path).find(10, one), std::runtime_error);
+    corrupt(10, players);
+    const int roles = corrupt(11, 0xFF);
+    CHECK_THROWS_AS(ArchiveReader(path).scan([](const ArchivedGame&){}), std::runtime_error);
+    corrupt(11, roles);
+    CHECK(ArchiveReader(path).find(10, one));
+    std::remove(path.c_str());
+}
+
+TEST_CASE("S16. Bitmap index answers event queries like a full replay") {
+    /* sparse and dense chunks against std::set */
+    Rng rng(16);
+    std::set<std::uint32_t> sa, sb;
+    Bitmap a, b;
+    for(int k=0;k<20000;++k) {
+        const std::uint32_t x = static_cast<std::uint32_t>(rng.below(1u << 17));           // dense
+        const std::uint32_t y = static_cast<std::uint32_t>(rng.below(1u << 22));           // sparse
+        a.add(x); sa.insert(x);
+        b.add(y); sb.insert(y);
+        if(k % 3 == 0) { b.add(x); sb.insert(x); }
+    }
+    auto same = [](const Bitmap& m, const std::set<std::uint32_t>& s) {
+        return m.size() == s.size() && m.ids() == std::vector<std::uint32_t>(s.begin(), s.end());
+    };
+    std::set<std::uint32_t> sAnd, sOr, sNot;
+    std::set_intersection(sa.begin(), sa.end(), sb.begin(), sb.end(), std::inserter(sAnd, sAnd.end()));
+    std::set_union       (sa.begin(), sa.end(), sb.begin(), sb.end(), std::inserter(sOr,  sOr.end()));
+    std::set_difference  (sa.begin(), sa.end(), sb.begin(), sb.end(), std::inserter(sNot, sNot.end()));
+    CHECK(same(a, sa));
+    CHECK(same(a & b, sAnd));
+    CHECK(same(a | b, sOr));
+    CHECK(same(a - b, sNot));
+    CHECK(((a - b) | (a & b)) == a);
+    CHECK((Bitmap::range(70000) - a).size() == 70000 - std::count_if(sa.begin(), sa.end(), [](std::uint32_t v){ return v < 70000; }));
+
+    /* index over a study archive vs. scanning the games by hand */
+    const std::string path = "/tmp/coup_test_idx.arc";
+    StudyConfig cfg;
+    cfg.games = 600;
+    cfg.seed  = 16;
+    {
+        ArchiveWriter arc(path);
+        runBalanceStudy(cfg, nullptr, &arc);
+    }
+    ArchiveReader r(path);
+    const GameIndex idx(r);
+    CHECK(idx.all().size() == cfg.games);
+
+    using T = coup::Action::Type;
+    Bitmap generalBlockedCoupAndWon, merchantArrested2, noJudgeGovernorWon;
+    std::vector<Bitmap> blockedBy(kRoleCount * kBlockKinds);
+    auto kindOf = [](T t) { return t == T::Tax ? BlockTax : t == T::Bribe ? BlockBribe : BlockCoup; };
+    r.scan([&](const ArchivedGame& g) {
+        const auto id = static_cast<std::uint32_t>(g.id);
+        const bool won = g.winner != GameResult::noWinner;
+        std::vector<int> arrested(g.roles.size(), 0);
+        std::vector<unsigned> blockedMask(g.roles.size(), 0);
+        bool winnerBlockedCoup = false;
+        /* the engine itself says what each Block answers */
+        Table t = Table::deal(g.roles);
+        replayGame(*t.game, g.actions, [&](const coup::Action& a) {
+            if(a.type == T::Arrest) ++arrested[*a.target];
+            if(a.type == T::Block) {
+                const BlockKind kind = kindOf(t.game->blockable()->type);
+                blockedMask[a.actor] |= 1u << kind;
+                if(kind == BlockCoup && won && a.actor == g.winner) winnerBlockedCoup = true;
+            }
+        });
+        for(std::size_t s=0;s<g.roles.size();++s)
+            for(unsigned k=0;k<kBlockKinds;++k)
+                if(blockedMask[s] >> k & 1) blockedBy[static_cast<std::size_t>(g.roles[s]) * kBlockKinds + k].add(id);
+        if(won && g.roles[g.winner] == Role::General && winnerBlockedCoup) generalBlockedCoupAndWon.add(id);
+        for(std::size_t s=0;s<g.roles.size();++s)
+            if(g.roles[s] == Role::Merchant && arrested[s] >= 2) { merchantArrested2.add(id); break; }
+        if(won && g.roles[g.winner] == Role::Governor
+           && std::find(g.roles.begin(), g.roles.end(), Role::Judge) == g.roles.end()) noJudgeGovernorWon.add(id);
+    });
+
+    CHECK((idx[Event::winner(Role::General)] & idx[Event::winnerBlocked(BlockCoup)]) == generalBlockedCoupAndWon);
+    CHECK(idx[Event::targeted(Role::Merchant, T::Arrest, 2)] == merchantArrested2);
+    CHECK(!merchantArrested2.empty());
+    CHECK((idx[Event::winner(Role::Governor)] & idx.except(idx[Event::seated(Role::Judge)])) == noJudgeGovernorWon);
+    CHECK((idx[Event::draw()] | idx.except(idx[Event::draw()])) == idx.all());
+    for(std::size_t role=0;role<kRoleCount;++role)
+        for(unsigned k=0;k<kBlockKinds;++k)
+            CHECK(idx[Event::blocked(static_cast<Role>(role), static_cast<BlockKind>(k))] == blockedBy[role * kBlockKinds + k]);
+    std::remove(path.c_str());
+
+    /* a block may come turns later: it answers the Tax still open, not the
+       Gather just before it; the window shuts when the Tax's actor moves again */
+    GameIndex late;
+    late.add({0, {Role::Merchant, Role::Spy, Role::Governor}, GameResult::noWinner,
+              {{T::Tax, 0, {}}, {T::Gather, 1, {}}, {T::Block, 2, {}}}});
+    late.add({1, {Role::Merchant, Role::Spy, Role::Governor}, GameResult::noWinner,
+              {{T::Tax, 0, {}}, {T::Gather, 1, {}}, {T::Gather, 2, {}}, {T::Gather, 0, {}}, {T::Block, 2, {}}}});
+    late.add({2, {Role::Judge, Role::Judge}, GameResult::noWinner,
+              {{T::Bribe, 0, {}}, {T::Gather, 0, {}}, {T::Block, 1, {}}}});
+    CHECK(late[Event::blocked(Role::Governor, BlockTax)].ids()  == std::vector<std::uint32_t>{0});
+    CHECK(late[Event::blocked(Role::Governor, BlockCoup)].empty());
+    CHECK(late[Event::blocked(Role::Judge,    BlockBribe)].ids() == std::vector<std::uint32_t>{2});
+}
+
+TEST_CASE("S17. Perft leaf counts match the pinned values, hashed or threaded") {
+    using L = std::vector<std::uint64_t>;
+    PerftConfig cfg;
+    cfg.roles = {Role::Governor, Role::Judge, Role::General};
+    cfg.depth = 6;
+    CHECK(perft(cfg).leaves == L{3, 12, 49, 196, 717, 2702});
+
+    cfg.coins = {7, 4, 5};
+    cfg.depth = 5;
+    const L known{9, 57, 355, 2300, 13384};
+    CHECK(perft(cfg).leaves == known);
+    cfg.threads = 3;
+    CHECK(perft(cfg).leaves == known);
+    cfg.hashMb = 1;
+    CHECK(perft(cfg).leaves == known);
+
+    cfg.coins = {7, 4};
+    CHECK_THROWS_AS(perft(cfg), std::invalid_argument);
+}
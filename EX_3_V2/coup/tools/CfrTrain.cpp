@@ -0,0 +1,60 @@
+// thelet.shevach@gmail.com
+/*  CfrTrain – trains the block / no-block reaction table with CFR+.
+
+    usage: ./CfrTrain [--windows N] [--threads T] [--rollouts K]
+                      [--seed S] [--out reactions.cfr]
+
+    The output is a 4 KiB ReactionTable (see sim/Cfr.hpp); load it with
+    ReactionTable::load and hand it to a CfrBot.                        */
+#include "sim/Cfr.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace coup_sim;
+
+int main(int argc, char** argv)
+{
+    CfrConfig cfg;
+    cfg.threads = std::max(1u, std::thread::hardware_concurrency());
+    std::string out = "reactions.cfr";
+    for(int i=1;i<argc;++i){
+        std::string a = argv[i];
+        if     (a=="--windows"  && i+1<argc) cfg.windows  = std::stoull(argv[++i]);
+        else if(a=="--threads"  && i+1<argc) cfg.threads  = static_cast<unsigned>(std::stoul(argv[++i]));
+        else if(a=="--rollouts" && i+1<argc) cfg.rollouts = std::stoul(argv[++i]);
+        else if(a=="--seed"     && i+1<argc) cfg.seed     = std::stoull(argv[++i]);
+        else if(a=="--out"      && i+1<argc) out          = argv[++i];
+        else { std::cerr << "unknown option " << a << '\n'; return 2; }
+    }
+
+    try {
+        auto t0 = std::chrono::steady_clock::now();
+        CfrTrainer trainer(cfg);
+        trainer.train();
+        const ReactionTable table = trainer.averageStrategy();
+        table.save(out);
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count();
+        std::printf("%llu windows in %.1fs → %s\n", static_cast<unsigned long long>(cfg.windows), secs, out.c_str());
+
+        /* most visited information sets per block kind */
+        const char* kinds[3] = {"undo tax", "undo bribe", "block coup"};
+        for(unsigned kind=0; kind<3; ++kind) {
+            std::uint64_t visits = 0;
+            double        sum = 0;
+            for(std::size_t k=kind; k<kReactionKeys; k+=4) {
+                visits += trainer.visits(static_cast<std::uint16_t>(k));
+                sum    += trainer.visits(static_cast<std::uint16_t>(k)) * table.blockProb(static_cast<std::uint16_t>(k));
+            }
+            std::printf("  %-10s  %8llu decisions  mean P(block) %.2f\n", kinds[kind],
+                        static_cast<unsigned long long>(visits), visits ? sum / double(visits) : 0.0);
+        }
+    } catch(const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
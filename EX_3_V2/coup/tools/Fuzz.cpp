@@ -0,0 +1,260 @@
+// thelet.shevach@gmail.com
+/*  Fuzz – invariant fuzzer for Game::perform / Game::block.
+
+    Input bytes: [players] [role × players] then (op, arg) pairs.
+      op & 0xF0 != 0 : play legal move  arg % |legalMoves ∪ legalBlocks|;
+                       with op & 0x80 a Tax / Bribe / Coup is proposed
+                       instead, and while a proposal is open arg picks
+                       one of its blocks or the commit (which a raw
+                       call may have made impossible)
+      otherwise      : raw call – op % 11 picks Gather..Coup, Invest,
+                       Block, spyPeek, spyBlockArrest, governorUndoTax;
+                       actor = arg % n, target = arg / n % n
+    Raw calls may be rejected; either way, after every step:
+      • every seat holds ≥ 0 coins, somebody is alive
+      • the turn holder is alive; nextAlive/prevAlive agree with a scan
+      • winner()/winnerIndex() answer iff exactly one is left; living()
+        lists exactly the living seats in order, aliveCount()/isOver() agree
+      • a mirror fed only by the Delta stream matches the table
+        (so rejected calls change nothing and accepted ones say so)
+      • tick never goes back; only a block brings a player back
+
+    libFuzzer:  clang++ -std=c++20 -Iinclude -DCOUP_LIBFUZZER -fsanitize=fuzzer,address
+                with every source in src/core and src/sim plus tools/Fuzz.cpp
+    standalone: ./Fuzz [--seconds S] [--runs N] [--len L] [--seed X] [crash files…]
+                replays the given files, otherwise feeds random inputs and
+                writes the first failing one to crash-<seed>-<run>.bin       */
+#include "core/Player.hpp"
+#include "sim/MoveGen.hpp"
+#include "sim/Rng.hpp"
+#include "sim/Table.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace coup_sim;
+using coup::Action;
+using coup::Game;
+
+namespace {
+
+std::uint64_t g_actions  = 0;
+std::uint64_t g_rejected = 0;
+std::string   g_crashFile;                 // standalone: where to save the input
+const std::uint8_t* g_data = nullptr;
+std::size_t         g_size = 0;
+
+[[noreturn]] void fail(std::size_t step, const char* what) {
+    std::fprintf(stderr, "invariant violated at step %zu: %s\n", step, what);
+    if(!g_crashFile.empty() && g_data) {
+        std::ofstream(g_crashFile, std::ios::binary).write(reinterpret_cast<const char*>(g_data),
+                                                           static_cast<std::streamsize>(g_size));
+        std::fprintf(stderr, "input written to %s\n", g_crashFile.c_str());
+    }
+    std::abort();
+}
+
+bool proposable(const Action& a) {
+    return a.type == Action::Type::Tax || a.type == Action::Type::Bribe || a.type == Action::Type::Coup;
+}
+
+bool commit(Game& g) {
+    try { g.commit(); return true; }
+    catch(const std::exception&) { return false; }
+}
+
+/* what the Delta stream says the table looks like */
+struct Mirror {
+    std::vector<int>  coins;
+    std::vector<bool> alive;
+    std::size_t       turn{0};
+
+    void operator()(const coup::Delta& d) {
+        for(std::size_t i=0;i<d.nCoins;++i) coins[d.coins[i].seat] = static_cast<int>(d.coins[i].value);
+        if(d.died    != coup::Delta::none) alive[d.died]    = false;
+        if(d.revived != coup::Delta::none) alive[d.revived] = true;
+        if(d.turn    != coup::Delta::none) turn = d.turn;
+    }
+};
+
+void check(const Game& g, const Mirror& m, std::size_t step, std::size_t& tick,
+           std::size_t& alive, bool wasBlock, bool checkWinner)
+{
+    const auto& roster = g.roster();
+    std::size_t living = 0;
+    for(std::size_t i=0;i<roster.size();++i) {
+        if(roster[i]->coins() < 0)           fail(step, "negative coins");
+        if(roster[i]->coins() != m.coins[i]) fail(step, "coins changed without a delta");
+        if(g.alive(i) != m.alive[i])         fail(step, "alive changed without a delta");
+        living += g.alive(i);
+    }
+    if(!living)                              fail(step, "nobody is alive");
+    if(!g.alive(g.turnIndex()))              fail(step, "turn holder is eliminated");
+    if(g.turnIndex() != m.turn)              fail(step, "turn changed without a delta");
+    for(std::size_t i=0;i<roster.size();++i) {              // ring = next living seat by scan
+        if(!g.alive(i)) continue;
+        std::size_t j = (i + 1) % roster.size();
+        while(!g.alive(j)) j = (j + 1) % roster.size();
+        if(g.nextAlive(i) != j || g.prevAlive(j) != i) fail(step, "living-seat ring is broken");
+    }
+    if(g.tick() < tick)                      fail(step, "tick went back");
+    if(living > alive && !wasBlock)          fail(step, "player revived without a block");
+    tick  = g.tick();
+    alive = living;
+
+    if(living != g.aliveCount() || g.isOver() != (living == 1))
+                                             fail(step, "alive count is stale");
+    std::size_t viewed = 0, last = 0;
+    const auto view = g.living();
+    for(auto it=view.begin(); it!=view.end(); ++it, ++viewed) {
+        if(!g.alive(it.seat()) || (viewed && it.seat() <= last)) fail(step, "living() out of order");
+        last = it.seat();
+    }
+    if(viewed != living)                     fail(step, "living() skips players");
+
+    if(living == 1) {
+        if(g.winnerIndex() != g.turnIndex() || g.winner() != roster[g.turnIndex()]->name())
+                                             fail(step, "winner is not the survivor");
+    } else if(checkWinner) {
+        bool threw = false;
+        try { (void)g.winner(); } catch(const coup::GameNotFinished&) { threw = true; }
+        if(!threw)                           fail(step, "winner while several are alive");
+    }
+}
+
+/* one raw engine call; false if the engine rejected it */
+bool raw(Table& t, std::uint8_t op, std::uint8_t arg) {
+    Game&             g = *t.game;
+    const std::size_t n = t.seats.size();
+    const std::size_t actor = arg % n, target = arg / n % n;
+    coup::Player&     a = *t.seats[actor];
+    coup::Player&     b = *t.seats[target];
+    try {
+        switch(op % 11) {
+        case 0: case 1: case 2: case 3: case 4: case 5:
+            g.perform({static_cast<Action::Type>(op % 11), actor,
+                       op % 11 >= 3 ? std::optional<std::size_t>(target) : std::nullopt});
+            break;
+        case 6:  g.perform({Action::Type::Invest, actor, {}});  break;
+        case 7:  g.block  ({Action::Type::Block,  actor, {}});  break;
+        case 8:  g.spyPeek(a, b);                                break;
+        case 9:  g.spyBlockArrest(a, b);                         break;
+        default: g.governorUndoTax(a, b);                        break;
+        }
+        return true;
+    } catch(const coup::IllegalAction&) {
+        return false;
+    }
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size)
+{
+    if(size < 2) return 0;
+    const std::size_t n = 2 + data[0] % 5;
+    std::vector<Role> roles(n);
+    for(std::size_t i=0;i<n;++i)
+        roles[i] = static_cast<Role>((1 + i < size ? data[1 + i] : i) % kRoleCount);
+
+    Table t = Table::deal(roles);
+    Game& g = *t.game;
+    Mirror m{std::vector<int>(n, 0), std::vector<bool>(n, true), 0};
+    g.subscribe(std::ref(m));
+
+    static std::vector<Action> moves;
+    std::size_t tick = 0, alive = n;
+    for(std::size_t p = 1 + n, step = 0; p + 1 < size; p += 2, ++step) {
+        const std::uint8_t op = data[p], arg = data[p + 1];
+        bool wasBlock;
+        if(op & 0xF0 && g.pending()) {                   // window open: a block or the commit
+            moves.clear();
+            legalBlocks(g, moves);
+            const std::size_t k = arg % (moves.size() + 1);
+            wasBlock = k < moves.size();
+            if(wasBlock) apply(g, moves[k]);
+            else if(!commit(g)) ++g_rejected;            // a raw call drained the proposer
+        } else if(op & 0xF0) {
+            moves.clear();
+            legalMoves(g, moves);
+            if(g.blockable()) legalBlocks(g, moves);
+            if(moves.empty()) break;                     // game over
+            const Action& a = moves[arg % moves.size()];
+            wasBlock = a.type == Action::Type::Block;
+            if(op & 0x80 && proposable(a)) g.propose(a);
+            else                           apply(g, a);
+        } else {
+            wasBlock = op % 11 == 7;
+            if(!raw(t, op, arg)) ++g_rejected;
+        }
+        ++g_actions;
+        check(g, m, step, tick, alive, wasBlock, !(op & 0xF0));
+    }
+    return 0;
+}
+
+#ifndef COUP_LIBFUZZER
+static std::vector<std::uint8_t> readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if(!in) throw std::runtime_error("cannot open " + path);
+    return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+int main(int argc, char** argv)
+{
+    double        seconds = 10;
+    std::uint64_t runs = 0, seed = 1;
+    std::size_t   len = 4096;
+    std::vector<std::string> files;
+    for(int i=1;i<argc;++i){
+        std::string a = argv[i];
+        if     (a=="--seconds" && i+1<argc) seconds = std::stod(argv[++i]);
+        else if(a=="--runs"    && i+1<argc) runs    = std::stoull(argv[++i]);
+        else if(a=="--len"     && i+1<argc) len     = std::max<std::size_t>(2, std::stoull(argv[++i]));
+        else if(a=="--seed"    && i+1<argc) seed    = std::stoull(argv[++i]);
+        else if(!a.empty() && a[0]=='-') { std::cerr << "unknown option " << a << '\n'; return 2; }
+        else files.push_back(a);
+    }
+
+    try {
+        for(const auto& f : files) {
+            const auto bytes = readFile(f);
+            g_data = bytes.data();
+            g_size = bytes.size();
+            LLVMFuzzerTestOneInput(bytes.data(), bytes.size());
+            std::printf("%s: ok\n", f.c_str());
+        }
+    } catch(const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+    if(!files.empty()) return 0;
+
+    Rng rng(seed);
+    std::vector<std::uint8_t> input;
+    const auto t0 = std::chrono::steady_clock::now();
+    std::uint64_t run = 0;
+    for(; !runs || run < runs; ++run) {
+        if((run & 63) == 0 && std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() >= seconds)
+            break;
+        input.resize(2 + rng.below(len - 1));
+        for(auto& b : input) b = static_cast<std::uint8_t>(rng.next());
+        g_crashFile = "crash-" + std::to_string(seed) + "-" + std::to_string(run) + ".bin";
+        g_data = input.data();
+        g_size = input.size();
+        LLVMFuzzerTestOneInput(input.data(), input.size());
+    }
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::printf("%llu inputs, %llu actions (%llu rejected) in %.1fs – %.2fM actions/s\n",
+                static_cast<unsigned long long>(run), static_cast<unsigned long long>(g_actions),
+                static_cast<unsigned long long>(g_rejected), secs, g_actions / secs / 1e6);
+    return 0;
+}
+#endif
@@ -0,0 +1,60 @@
+// thelet.shevach@gmail.com
+/*  Perft – counts every legal action sequence (moves and block reactions)
+    from a table setup to each depth, and reports nodes per second.  The
+    counts are pinned in tests/test_sim.cpp (S17), so a changed number
+    means a changed rule.
+
+    usage: ./Perft --roles Governor,Spy,General [--coins 0,0,7]
+                   [--depth N] [--threads T] [--hash MB]                 */
+#include "sim/Perft.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace coup_sim;
+
+static Role parseRole(const std::string& name) {
+    for(std::size_t r=0;r<kRoleCount;++r)
+        if(name == roleName(static_cast<Role>(r))) return static_cast<Role>(r);
+    throw std::invalid_argument("unknown role " + name);
+}
+
+int main(int argc, char** argv)
+{
+    PerftConfig cfg;
+    cfg.threads = std::max(1u, std::thread::hardware_concurrency());
+
+    try {
+        for(int i=1;i<argc;++i){
+            std::string a = argv[i];
+            if     (a=="--depth"   && i+1<argc) cfg.depth   = static_cast<unsigned>(std::stoul(argv[++i]));
+            else if(a=="--threads" && i+1<argc) cfg.threads = static_cast<unsigned>(std::stoul(argv[++i]));
+            else if(a=="--hash"    && i+1<argc) cfg.hashMb  = std::stoull(argv[++i]);
+            else if(a=="--roles"   && i+1<argc) {
+                std::stringstream ss(argv[++i]);
+                for(std::string r; std::getline(ss,r,','); ) cfg.roles.push_back(parseRole(r));
+            }
+            else if(a=="--coins"   && i+1<argc) {
+                std::stringstream ss(argv[++i]);
+                for(std::string c; std::getline(ss,c,','); ) cfg.coins.push_back(std::stoi(c));
+            }
+            else { std::cerr << "unknown option " << a << '\n'; return 2; }
+        }
+
+        const PerftResult r = perft(cfg);
+        for(std::size_t d=0; d<r.leaves.size(); ++d)
+            std::printf("depth %2zu  %16llu\n", d + 1, static_cast<unsigned long long>(r.leaves[d]));
+        std::printf("%llu nodes in %.3fs (%.2fM nodes/s, %u threads%s)\n",
+                    static_cast<unsigned long long>(r.nodes), r.seconds,
+                    r.seconds > 0 ? double(r.nodes) / r.seconds / 1e6 : 0.0, cfg.threads,
+                    cfg.hashMb ? ", hashed" : "");
+    } catch(const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
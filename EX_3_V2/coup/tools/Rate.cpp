@@ -0,0 +1,116 @@
+// thelet.shevach@gmail.com
+/*  Rate – Elo / TrueSkill ratings per bot and per role from a game log.
+
+    Reads one or more columnar game files (written by ./Balance), feeds
+    them to RatingEngine in batches and prints the final tables.  With
+    --checkpoint the engine state is saved every --every games and, if the
+    file already exists, the run resumes after the games it has seen.
+
+    usage: ./Rate games.col... [--model elo|trueskill] [--threads T]
+                  [--batch B] [--bots random,greedy]
+                  [--checkpoint FILE] [--every N]                      */
+#include "sim/Rating.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace coup_sim;
+
+static void print(const char* what, const Ratings& r, const std::vector<std::string>& names, RatingModel m) {
+    std::printf("%s\n", what);
+    std::vector<std::size_t> order(r.size());
+    for(std::size_t i=0;i<order.size();++i) order[i] = i;
+    auto key = [&](std::size_t i){ return m==RatingModel::Elo ? r.mu[i] : r.conservative(i); };
+    std::sort(order.begin(), order.end(), [&](auto a, auto b){ return key(a) > key(b); });
+    for(auto i : order) {
+        if(!r.games[i]) continue;
+        const std::string name = i<names.size() ? names[i] : "#" + std::to_string(i);
+        if(m==RatingModel::Elo) std::printf("  %-10s %8.1f  (%llu seats)\n", name.c_str(), r.mu[i],
+                                            static_cast<unsigned long long>(r.games[i]));
+        else std::printf("  %-10s mu %6.2f  sigma %5.2f  (%llu seats)\n", name.c_str(), r.mu[i],
+                         std::sqrt(r.sigma2[i]), static_cast<unsigned long long>(r.games[i]));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    RatingConfig cfg;
+    cfg.threads = std::max(1u, std::thread::hardware_concurrency());
+    std::size_t batchSize = 65536;
+    std::uint64_t every = 10'000'000;
+    std::string checkpoint;
+    std::vector<std::string> files, botNames{"random","greedy"};
+    bool usage = false;
+
+    for(int i=1;i<argc;++i){
+        std::string a = argv[i];
+        if     (a=="--model"      && i+1<argc) {
+            const std::string m = argv[++i];
+            usage     = usage || (m!="elo" && m!="trueskill");
+            cfg.model = m=="trueskill" ? RatingModel::TrueSkill : RatingModel::Elo;
+        }
+        else if(a=="--threads"    && i+1<argc) cfg.threads = static_cast<unsigned>(std::stoul(argv[++i]));
+        else if(a=="--batch"      && i+1<argc) batchSize   = std::max<std::size_t>(1, std::stoull(argv[++i]));
+        else if(a=="--checkpoint" && i+1<argc) checkpoint  = argv[++i];
+        else if(a=="--every"      && i+1<argc) every       = std::stoull(argv[++i]);
+        else if(a=="--bots"       && i+1<argc) {
+            botNames.clear();
+            std::stringstream ss(argv[++i]);
+            for(std::string b; std::getline(ss,b,','); ) botNames.push_back(b);
+        }
+        else files.push_back(a);
+    }
+    if(files.empty() || usage) { std::cerr << "usage: ./Rate games.col... [options]\n"; return 2; }
+
+    try {
+        RatingEngine eng(16, cfg);                 // GameRecord packs bot ids in 4 bits
+        if(!checkpoint.empty() && std::ifstream(checkpoint)) {
+            eng.loadCheckpoint(checkpoint);
+            std::printf("resuming after %llu games\n", static_cast<unsigned long long>(eng.gamesSeen()));
+        }
+
+        auto t0 = std::chrono::steady_clock::now();
+        std::uint64_t read = 0, nextSave = eng.gamesSeen() + every;
+        std::vector<GameRecord> batch;
+        batch.reserve(batchSize);
+        RowGroup g;
+
+        auto flush = [&]{
+            eng.update(batch);
+            batch.clear();
+            if(!checkpoint.empty() && eng.gamesSeen() >= nextSave) {
+                eng.saveCheckpoint(checkpoint);
+                nextSave = eng.gamesSeen() + every;
+            }
+        };
+        for(const auto& file : files) {
+            ColumnarReader in(file);
+            while(in.next(g))
+                for(std::size_t i=0;i<g.size();++i)
+                    if(read++ >= eng.gamesSeen()) {          // skip what the checkpoint has
+                        batch.push_back(g.row(i));
+                        if(batch.size() == batchSize) flush();
+                    }
+        }
+        flush();
+        if(!checkpoint.empty()) eng.saveCheckpoint(checkpoint);
+
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count();
+        std::printf("%llu games rated in %.2fs\n", static_cast<unsigned long long>(eng.gamesSeen()), secs);
+        print("bots",  eng.bots(),  botNames, cfg.model);
+        std::vector<std::string> roleNames;
+        for(std::size_t r=0;r<kRoleCount;++r) roleNames.push_back(roleName(static_cast<Role>(r)));
+        print("roles", eng.roles(), roleNames, cfg.model);
+    } catch(const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}